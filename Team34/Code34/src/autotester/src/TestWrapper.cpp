@@ -43,13 +43,8 @@ void TestWrapper::evaluate(std::string query, std::list<std::string>& results)
         return;
     }
 
-    struct uwu
-    {
-        ~uwu()
-        {
-            util::Arena::global().clear();
-        }
-    } tmp;
+    // everything the query allocates in the arena is given back (but not freed) once it's done.
+    util::ArenaScope arena_scope {};
 
     try
     {
@@ -58,8 +53,9 @@ void TestWrapper::evaluate(std::string query, std::list<std::string>& results)
         auto query_ast = pql::parser::parsePQL(query);
         util::logfmt("pql:ast", "Generated AST: {}", query_ast->toString());
 
+        // rows are written straight into the results, without building a list of our own first.
         auto eval = pql::eval::Evaluator(this->pkb.get(), std::move(query_ast));
-        results = eval.evaluate();
+        eval.evaluate([&results](zst::str_view row) { results.emplace_back(row.data(), row.size()); });
     }
     catch(const util::Exception& e)
     {
@@ -7,6 +7,10 @@
 
 namespace util
 {
+    // a bump allocator. memory is never given back one allocation at a time; instead, reset() hands all of
+    // the chunks back at once (keeping them around for the next query), and clear() frees them for real.
+    //
+    // each thread has its own arena (see current()), so there is no locking anywhere.
     struct Arena
     {
         struct Chunk
@@ -18,13 +22,53 @@ namespace util
             Chunk* next;
         };
 
+        // these are for benchmarking; the peaks are since the last resetPeaks().
+        struct Stats
+        {
+            size_t bytes_used = 0;
+            size_t peak_bytes_used = 0;
+            size_t num_chunks = 0;
+            size_t peak_num_chunks = 0;
+            size_t chunks_allocated = 0;
+            size_t chunks_recycled = 0;
+        };
+
+        Arena() = default;
+        ~Arena();
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
         void* allocate(size_t n, size_t align);
+        // everything allocated so far is gone, but the chunks are kept for later allocations
+        void reset();
+        // everything allocated so far is gone, and so are the chunks
         void clear();
 
-        static Arena& global();
+        const Stats& stats() const;
+        void resetPeaks();
+
+        // the arena of the calling thread
+        static Arena& current();
 
     private:
         Chunk* head = nullptr;
+        Chunk* free_list = nullptr;
+        size_t free_bytes = 0;
+        Stats m_stats {};
+
+        Chunk* get_chunk(size_t minimum);
+    };
+
+    // resets the current arena when it goes out of scope, so everything allocated while evaluating
+    // a query is given back afterwards. nested scopes only reset at the outermost one.
+    struct ArenaScope
+    {
+        ArenaScope();
+        ~ArenaScope();
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
     };
 
     template <typename T>
@@ -41,7 +85,7 @@ namespace util
 
         inline value_type* allocate(std::size_t n)
         {
-            return (value_type*) Arena::global().allocate(n * sizeof(value_type), alignof(value_type));
+            return (value_type*) Arena::current().allocate(n * sizeof(value_type), alignof(value_type));
             // return static_cast<value_type*>(::operator new(n * sizeof(value_type)));
         }
 
@@ -69,4 +113,4 @@ namespace util
 
     template <typename K, typename V>
     using ArenaMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, arena_allocator<std::pair<const K, V>>>;
-}
\ No newline at end of file
+}
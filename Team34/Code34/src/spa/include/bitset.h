@@ -0,0 +1,179 @@
+// bitset.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "exceptions.h"
+
+namespace util
+{
+    // a dynamically-sized bitset that covers the index range [first, last). indices are always
+    // absolute, so a set that only ever holds a small window of a large index space (eg. the
+    // statements of one procedure) only pays for that window.
+    struct BitSet
+    {
+        BitSet() = default;
+        explicit BitSet(size_t size) : BitSet(0, size) { }
+
+        BitSet(size_t first, size_t last) : m_first_word(first / 64), m_last(last)
+        {
+            if(last > first)
+                m_words.resize(((last + 63) / 64) - m_first_word, 0);
+        }
+
+        size_t first() const { return m_first_word * 64; }
+        size_t last() const { return m_last; }
+
+        bool test(size_t idx) const
+        {
+            if(idx < this->first() || idx >= m_last)
+                return false;
+
+            return (m_words[idx / 64 - m_first_word] >> (idx % 64)) & 1;
+        }
+
+        void set(size_t idx)
+        {
+            spa_assert(idx >= this->first() && idx < m_last);
+            m_words[idx / 64 - m_first_word] |= (uint64_t) 1 << (idx % 64);
+        }
+
+        void reset(size_t idx)
+        {
+            if(idx < this->first() || idx >= m_last)
+                return;
+
+            m_words[idx / 64 - m_first_word] &= ~((uint64_t) 1 << (idx % 64));
+        }
+
+        // the other set's window must lie within ours. returns true if any new bits were set.
+        bool unionWith(const BitSet& other)
+        {
+            if(other.m_words.empty())
+                return false;
+
+            spa_assert(other.m_first_word >= m_first_word);
+            spa_assert(other.m_first_word + other.m_words.size() <= m_first_word + m_words.size());
+
+            uint64_t changed = 0;
+            auto* dst = m_words.data() + (other.m_first_word - m_first_word);
+            for(size_t i = 0; i < other.m_words.size(); i++)
+            {
+                changed |= other.m_words[i] & ~dst[i];
+                dst[i] |= other.m_words[i];
+            }
+
+            return changed != 0;
+        }
+
+        void intersectWith(const BitSet& other)
+        {
+            for(size_t i = 0; i < m_words.size(); i++)
+                m_words[i] &= other.wordAt(m_first_word + i);
+        }
+
+        void subtract(const BitSet& other)
+        {
+            for(size_t i = 0; i < m_words.size(); i++)
+                m_words[i] &= ~other.wordAt(m_first_word + i);
+        }
+
+        bool intersects(const BitSet& other) const
+        {
+            for(size_t i = 0; i < m_words.size(); i++)
+            {
+                if(m_words[i] & other.wordAt(m_first_word + i))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool any() const
+        {
+            for(auto w : m_words)
+            {
+                if(w != 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        size_t count() const
+        {
+            size_t ret = 0;
+            for(auto w : m_words)
+                ret += popcount(w);
+
+            return ret;
+        }
+
+        // calls fn(idx) for every set bit, in increasing order.
+        template <typename Fn>
+        void forEach(Fn&& fn) const
+        {
+            for(size_t i = 0; i < m_words.size(); i++)
+            {
+                for(uint64_t w = m_words[i]; w != 0; w &= (w - 1))
+                    fn((m_first_word + i) * 64 + ctz(w));
+            }
+        }
+
+        bool operator==(const BitSet& other) const
+        {
+            size_t lo = std::min(m_first_word, other.m_first_word);
+            size_t hi = std::max(m_first_word + m_words.size(), other.m_first_word + other.m_words.size());
+            for(size_t w = lo; w < hi; w++)
+            {
+                if(this->wordAt(w) != other.wordAt(w))
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool operator!=(const BitSet& other) const { return !(*this == other); }
+
+    private:
+        uint64_t wordAt(size_t word_idx) const
+        {
+            if(word_idx < m_first_word || word_idx >= m_first_word + m_words.size())
+                return 0;
+
+            return m_words[word_idx - m_first_word];
+        }
+
+        static size_t ctz(uint64_t w)
+        {
+#if defined(_MSC_VER)
+            unsigned long idx = 0;
+            _BitScanForward64(&idx, w);
+            return idx;
+#else
+            return (size_t) __builtin_ctzll(w);
+#endif
+        }
+
+        static size_t popcount(uint64_t w)
+        {
+#if defined(_MSC_VER)
+            return (size_t) __popcnt64(w);
+#else
+            return (size_t) __builtin_popcountll(w);
+#endif
+        }
+
+        size_t m_first_word = 0;
+        size_t m_last = 0;
+        std::vector<uint64_t> m_words {};
+    };
+}
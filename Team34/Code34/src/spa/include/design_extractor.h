@@ -30,8 +30,8 @@ namespace pkb
         void processStmtList(const simple::ast::StmtList* list, TraversalState& ts);
         void processExpr(const simple::ast::Expr* expr, Statement* stmt, const TraversalState& ts);
 
-        void processUses(const std::string& var, Statement* stmt, const TraversalState& ts);
-        void processModifies(const std::string& var, Statement* stmt, const TraversalState& ts);
+        void processUses(VarId var, Statement* stmt, const TraversalState& ts);
+        void processModifies(VarId var, Statement* stmt, const TraversalState& ts);
 
         void processNextRelations();
         void processBipRelations();
@@ -39,6 +39,8 @@ namespace pkb
 
         std::vector<Procedure*> processCallGraph();
 
+        void assignIds();
+
     private:
         const simple::ast::Program* m_program {};
         std::unique_ptr<ProgramKB> m_pkb {};
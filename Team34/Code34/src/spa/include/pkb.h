@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -10,6 +11,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "bitset.h"
 #include "pql/parser/ast.h"
 #include "simple/ast.h"
 
@@ -20,6 +22,15 @@ namespace pkb
     using StatementNum = simple::ast::StatementNum;
     using StatementSet = std::unordered_set<StatementNum>;
 
+    // variables, procedures and constants are numbered densely from 0 by the design extractor,
+    // so the evaluator can work with these instead of hashing and comparing names everywhere.
+    using VarId = uint32_t;
+    using ProcId = uint32_t;
+    using ConstId = uint32_t;
+
+    using VarIdSet = std::unordered_set<VarId>;
+    using ProcIdSet = std::unordered_set<ProcId>;
+
 #define MOVE_ONLY_TYPE(TypeName)               \
     TypeName(TypeName&&) = default;            \
     TypeName& operator=(TypeName&&) = default; \
@@ -34,40 +45,43 @@ namespace pkb
 
         Procedure(const simple::ast::Procedure* ast_proc);
 
-        bool usesVariable(const std::string& varname) const;
-        bool modifiesVariable(const std::string& varname) const;
+        // variables and procedures are referred to by id; see ProgramKB::getVariableWithId and friends.
+        bool usesVariable(VarId var) const;
+        bool modifiesVariable(VarId var) const;
 
-        const std::unordered_set<std::string>& getUsedVariables() const;
-        const std::unordered_set<std::string>& getModifiedVariables() const;
+        const VarIdSet& getUsedVariableIds() const;
+        const VarIdSet& getModifiedVariableIds() const;
 
-        bool callsProcedure(const std::string& procname) const;
-        bool callsProcedureTransitively(const std::string& procname) const;
+        bool callsProcedure(ProcId proc) const;
+        bool callsProcedureTransitively(ProcId proc) const;
 
-        bool isCalledByProcedure(const std::string& procname) const;
-        bool isTransitivelyCalledByProcedure(const std::string& procname) const;
+        bool isCalledByProcedure(ProcId proc) const;
+        bool isTransitivelyCalledByProcedure(ProcId proc) const;
 
-        const std::unordered_set<std::string>& getAllCallers() const;
-        const std::unordered_set<std::string>& getAllCalledProcedures() const;
+        const ProcIdSet& getAllCallerIds() const;
+        const ProcIdSet& getAllCalledProcedureIds() const;
 
-        const std::unordered_set<std::string>& getAllTransitiveCallers() const;
-        const std::unordered_set<std::string>& getAllTransitivelyCalledProcedures() const;
+        const ProcIdSet& getAllTransitiveCallerIds() const;
+        const ProcIdSet& getAllTransitivelyCalledProcedureIds() const;
 
         const StatementSet& getCallStmts() const;
 
+        ProcId getId() const;
         std::string getName() const;
         const simple::ast::Procedure* getAstProc() const;
 
     private:
         const simple::ast::Procedure* m_ast_proc = 0;
+        ProcId m_id = 0;
 
-        std::unordered_set<std::string> m_uses {};
-        std::unordered_set<std::string> m_modifies {};
+        VarIdSet m_uses_ids {};
+        VarIdSet m_modifies_ids {};
 
-        std::unordered_set<std::string> m_calls {};
-        std::unordered_set<std::string> m_called_by {};
+        ProcIdSet m_calls_ids {};
+        ProcIdSet m_called_by_ids {};
 
-        std::unordered_set<std::string> m_calls_transitive {};
-        std::unordered_set<std::string> m_called_by_transitive {};
+        ProcIdSet m_calls_transitive_ids {};
+        ProcIdSet m_called_by_transitive_ids {};
 
         StatementSet m_call_stmts {};
     };
@@ -99,11 +113,11 @@ namespace pkb
 
         const simple::ast::Stmt* getAstStmt() const;
 
-        bool usesVariable(const std::string& var_name) const;
-        bool modifiesVariable(const std::string& var_name) const;
+        bool usesVariable(VarId var) const;
+        bool modifiesVariable(VarId var) const;
 
-        const std::unordered_set<std::string>& getUsedVariables() const;
-        const std::unordered_set<std::string>& getModifiedVariables() const;
+        const VarIdSet& getUsedVariableIds() const;
+        const VarIdSet& getModifiedVariableIds() const;
 
         // a->isParentOf(b) <=> Parent(a, b) holds
         // a->isChildOf(b) <=> Parent(b, a) holds
@@ -118,7 +132,7 @@ namespace pkb
         const StatementSet& getParent() const;
         const StatementSet& getAncestors() const;
 
-        const std::unordered_set<std::string>& getVariablesUsedInCondition() const;
+        const VarIdSet& getVariableIdsUsedInCondition() const;
 
         const simple::ast::Procedure* getProc() const;
         const StatementSet* maybeGetNextStatements() const;
@@ -166,11 +180,11 @@ namespace pkb
     private:
         const simple::ast::Stmt* m_stmt = nullptr;
 
-        std::unordered_set<std::string> m_uses {};
-        std::unordered_set<std::string> m_modifies {};
+        VarIdSet m_uses_ids {};
+        VarIdSet m_modifies_ids {};
 
         // only populated if the statement is an if or while.
-        std::unordered_set<std::string> m_condition_uses {};
+        VarIdSet m_condition_uses_ids {};
 
         StatementNum m_directly_before = 0;
         StatementNum m_directly_after = 0;
@@ -243,40 +257,111 @@ namespace pkb
         StatementSet getUsingStmtNumsFiltered(pql::ast::DESIGN_ENT ent) const;
         StatementSet getModifyingStmtNumsFiltered(pql::ast::DESIGN_ENT ent) const;
 
-        const std::unordered_set<std::string>& getUsingProcNames() const;
-        const std::unordered_set<std::string>& getModifyingProcNames() const;
+        const ProcIdSet& getUsingProcIds() const;
+        const ProcIdSet& getModifyingProcIds() const;
 
         const StatementSet& getReadStmts() const;
         const StatementSet& getPrintStmts() const;
 
+        VarId getId() const;
+        const std::string& getName() const;
+
     private:
+        VarId m_id = 0;
+        std::string m_name {};
+
         std::unordered_set<const Statement*> m_used_by {};
         std::unordered_set<const Statement*> m_modified_by {};
 
-        std::unordered_set<std::string> m_used_by_procs {};
-        std::unordered_set<std::string> m_modified_by_procs {};
+        ProcIdSet m_used_by_proc_ids {};
+        ProcIdSet m_modified_by_proc_ids {};
 
         StatementSet m_read_stmts {};
         StatementSet m_print_stmts {};
     };
 
-    struct pair_hash
+    // a directed graph over nodes [0, n) in compressed sparse row form: the edges leaving node i are
+    // [offsets[i], offsets[i + 1]) in the target array (and the parallel label array, if there is one).
+    // rows are sorted by target, so membership tests can binary search.
+    struct SparseGraph
     {
-        template <class T1, class T2>
-        std::size_t operator()(const std::pair<T1, T2>& p) const
+        struct Edge
         {
-            return util::hash_combine(p.first, p.second);
+            size_t from;
+            size_t to;
+            size_t label;
+        };
+
+        struct Row
+        {
+            const size_t* begin() const { return m_begin; }
+            const size_t* end() const { return m_end; }
+            size_t size() const { return (size_t) (m_end - m_begin); }
+            bool empty() const { return m_begin == m_end; }
+            size_t operator[](size_t i) const { return m_begin[i]; }
+
+            const size_t* m_begin;
+            const size_t* m_end;
+        };
+
+        SparseGraph() = default;
+
+        // duplicate edges (same endpoints and label) are merged.
+        SparseGraph(size_t num_nodes, std::vector<Edge> edges);
+
+        size_t size() const;
+        size_t numEdges() const;
+
+        Row targets(size_t node) const;
+        Row labels(size_t node) const;
+        bool hasEdge(size_t from, size_t to) const;
+
+        SparseGraph reversed() const;
+
+    private:
+        std::vector<size_t> m_offsets {};
+        std::vector<size_t> m_targets {};
+        std::vector<size_t> m_labels {};
+    };
+
+    // answers reachability queries over a directed graph with nodes numbered [0, n). strongly connected
+    // components (for the CFG, these are the while loops) are collapsed first, and the closure is computed
+    // once per component over the condensed dag, in reverse topological order.
+    struct ReachabilityIndex
+    {
+        ReachabilityIndex() = default;
+        ReachabilityIndex(const SparseGraph& graph);
+
+        // true if there is a non-empty path from a to b.
+        bool reaches(size_t a, size_t b) const;
+
+        template <typename Fn>
+        void forEachReachable(size_t a, Fn&& fn) const
+        {
+            auto comp = m_components[a];
+            m_rows[comp].forEach([&](size_t b) {
+                // the rows are reflexive, so a node only reaches its own component if that component has a cycle.
+                if(m_cyclic[comp] || m_components[b] != comp)
+                    fn(b);
+            });
         }
+
+    private:
+        std::vector<size_t> m_components {};
+        std::vector<bool> m_cyclic {};
+
+        // every node reachable from the component, including the members of the component itself.
+        std::vector<util::BitSet> m_rows {};
     };
 
     struct CFG
     {
         CFG(const ProgramKB* pkb, size_t v);
-        ~CFG();
 
         void addEdge(StatementNum stmt1, StatementNum stmt2);
         void addEdgeBip(StatementNum stmt1, StatementNum stmt2, size_t weight);
-        void computeDistMat();
+        void buildNextGraph();
+        void buildNextBipGraph();
         std::string getMatRep(int i) const;
         bool nextRelationExists() const;
         bool affectsRelationExists() const;
@@ -319,30 +404,117 @@ namespace pkb
         const StatementSet& getAffectingStatementsBip(StatementNum id) const;
         const StatementSet& getTransitivelyAffectingStatementsBip(StatementNum id) const;
 
-        bool isValidTransitivelyAffectBip(StatementNum stmt1, StatementNum stmt2, std::queue<StatementNum> q) const;
-
     private:
         size_t total_inst;
-        // adjacency matrix for lengths of shortest paths between 2 inst. i(row) is source and j(col) is destination.
-        size_t** adj_mat;
-        size_t** adj_mat_bip;
-        // cell value of 0 indicates that there are more than 1 weight, we store the ref here
-        std::unordered_map<std::pair<StatementNum, StatementNum>, std::unordered_set<size_t>, pair_hash> bip_ref;
+
+        // edges are collected while the design extractor walks the program, and only packed into
+        // the sparse graphs below once all of them are known.
+        std::vector<SparseGraph::Edge> m_pending_edges {};
+        std::vector<SparseGraph::Edge> m_pending_edges_bip {};
+
+        // nodes are statement numbers (node 0 is unused). bip edges are labelled with their weight:
+        // 1 for edges within a procedure, and (call stmt + 1) for call and return edges.
+        SparseGraph m_next_graph {};
+        SparseGraph m_prev_graph {};
+        SparseGraph m_next_bip_graph {};
+        SparseGraph m_prev_bip_graph {};
+
+        ReachabilityIndex m_next_closure {};
+        ReachabilityIndex m_prev_closure {};
 
         bool m_next_exists = false;
         bool m_next_bip_exists = false;
 
+        // statements are numbered procedure by procedure, so each procedure owns a contiguous range.
+        struct ProcRange
+        {
+            const simple::ast::Procedure* proc;
+            StatementNum first;
+            StatementNum last;
+        };
+
+        std::vector<ProcRange> m_procs {};
+        std::vector<size_t> m_stmt_procs {};
+
+        // affects is computed lazily, but a whole procedure at a time.
+        mutable std::vector<bool> m_affects_computed {};
+        void computeAffects(size_t proc_idx) const;
+        void computeAffectsOf(StatementNum id) const;
+
+        // Affects* over the whole program, built from the Affects edges of every procedure the
+        // first time any transitive query is made.
+        mutable bool m_affects_closure_built = false;
+        mutable ReachabilityIndex m_affects_closure {};
+        mutable ReachabilityIndex m_affected_by_closure {};
+        void buildAffectsClosure() const;
+
+        // the call structure for the bip relations, read off the labelled call edges. every
+        // statement that is not a call maps to NOT_A_CALL.
+        static constexpr size_t NOT_A_CALL = static_cast<size_t>(-1);
+        std::vector<size_t> m_call_targets {};
+        std::vector<std::vector<StatementNum>> m_proc_callsites {};
+        // the statements a procedure can return after; these are the return points of the gates, except
+        // that a trailing call is one itself (the call summary takes care of the callee's).
+        std::vector<bool> m_exit_stmts {};
+
+        // NextBip* and its reverse are composed from per-procedure summaries, all computed lazily:
+        //   body: every statement that can run once the procedure is called, until it returns.
+        //   returns: everything reachable after the procedure returns to any of its callers.
+        //   entries: everything that can run before the procedure is entered from any caller.
+        // a statement's row is its own procedure's Next* (plus the bodies of any calls on the way),
+        // combined with the returns (or entries) summary of that procedure.
+        mutable std::vector<std::optional<util::BitSet>> m_proc_bodies {};
+        mutable std::vector<std::optional<util::BitSet>> m_proc_returns {};
+        mutable std::vector<std::optional<util::BitSet>> m_proc_entries {};
+        mutable std::vector<std::optional<util::BitSet>> m_next_bip_rows {};
+        mutable std::vector<std::optional<util::BitSet>> m_prev_bip_rows {};
+
+        const util::BitSet& getProcBody(size_t proc_idx) const;
+        const util::BitSet& getProcReturns(size_t proc_idx) const;
+        const util::BitSet& getProcEntries(size_t proc_idx) const;
+        util::BitSet getTransitivelyNextInProcBip(StatementNum id) const;
+        const util::BitSet& getTransitivelyNextBipRow(StatementNum id) const;
+        const util::BitSet& getTransitivelyPreviousBipRow(StatementNum id) const;
+
+        // AffectsBip and AffectsBip* both propagate a set of tainted variables along realizable
+        // paths; the only difference is that AffectsBip* also taints the lhs of an affected
+        // assignment. calls and returns go through per-(procedure, variable) summaries, since
+        // taint propagation distributes over the variables in the set.
+        struct BipSummary
+        {
+            util::BitSet exit_taint {}; // variables tainted when the procedure returns
+            util::BitSet affected {};   // statements reached while a variable they use was tainted
+        };
+
+        struct AffectsBipEngine
+        {
+            bool transitive = false;
+            bool all_computed = false;
+            std::unordered_map<size_t, BipSummary> call_summaries {};
+            std::unordered_map<size_t, util::BitSet> return_summaries {};
+        };
+
+        static constexpr size_t NOT_A_VAR = static_cast<size_t>(-1);
+        size_t m_num_vars = 0;
+        std::vector<size_t> m_stmt_mod_vars {};
+        std::vector<util::BitSet> m_stmt_used_vars {};
+
+        mutable AffectsBipEngine m_affects_bip { false };
+        mutable AffectsBipEngine m_affects_bip_transitive { true };
+
+        BipSummary propagateTaint(AffectsBipEngine& engine, size_t proc_idx,
+            const std::vector<std::pair<StatementNum, util::BitSet>>& seeds) const;
+        const BipSummary& getCallSummary(AffectsBipEngine& engine, size_t proc_idx, size_t var) const;
+        const util::BitSet& getReturnSummary(AffectsBipEngine& engine, size_t proc_idx, size_t var) const;
+        StatementSet computeAffectedBip(AffectsBipEngine& engine, StatementNum id) const;
+        std::vector<StatementSet> computeAllAffectingBip(AffectsBipEngine& engine) const;
+
         // map of the starting point and return points for each proc
         std::unordered_map<std::string, std::pair<StatementNum, std::vector<StatementNum>>> gates;
         const ProgramKB* m_pkb;
-        std::unordered_map<StatementNum, StatementSet> adj_lst;
-        std::unordered_map<StatementNum, std::vector<std::pair<StatementNum, size_t>>> adj_lst_bip;
         std::unordered_map<StatementNum, const Statement*> assign_stmts;
         std::unordered_map<StatementNum, const Statement*> mod_stmts;
         std::unordered_map<StatementNum, const Statement*> call_stmts;
-        StatementSet getCurrentStack(const StatementNum id) const;
-        void addNextNodes(
-            StatementNum num, StatementSet& callStack, StatementSet& visited, std::queue<StatementNum>& q) const;
 
 
         friend struct DesignExtractor;
@@ -365,6 +537,15 @@ namespace pkb
         const Variable* maybeGetVariableNamed(const std::string& name) const;
         const Procedure* maybeGetProcedureNamed(const std::string& name) const;
 
+        const Variable& getVariableWithId(const VarId& id) const;
+        const Procedure& getProcedureWithId(const ProcId& id) const;
+        const std::string& getConstantWithId(const ConstId& id) const;
+        std::optional<ConstId> maybeGetConstantId(const std::string& value) const;
+
+        size_t getNumVariables() const;
+        size_t getNumProcedures() const;
+        size_t getNumConstants() const;
+
         bool nextRelationExists() const;
         bool callsRelationExists() const;
         bool parentRelationExists() const;
@@ -394,6 +575,12 @@ namespace pkb
         std::unordered_map<std::string, Variable> m_variables {};
         std::unordered_set<std::string> m_constants {};
         std::vector<Statement> m_statements {};
+
+        // indexed by id; the maps above own the actual entities.
+        std::vector<Variable*> m_variables_by_id {};
+        std::vector<Procedure*> m_procedures_by_id {};
+        std::vector<std::string> m_constants_by_id {};
+        std::unordered_map<std::string, ConstId> m_constant_ids {};
         std::unique_ptr<pkb::CFG> m_cfg {};
 
         std::unordered_map<pql::ast::DESIGN_ENT, StatementSet> m_stmt_kinds {};
@@ -34,13 +34,14 @@ namespace pql::eval
         SetWrapper<RelationParam> (*getAllRelated)(const pkb::ProgramKB*, const Entity&) {};
         SetWrapper<RelationParam> (*getAllInverselyRelated)(const pkb::ProgramKB*, const Entity&) {};
 
-        // getStatementAt, getProcedureNamed, getVariableNamed
+        // getStatementAt, getProcedureWithId
         const Entity& (pkb::ProgramKB::*getEntity)(const RelationParam&) const;
 
         // callsRelationExists, parentRelationExists, etc.
         bool (pkb::ProgramKB::*relationExists)() const;
 
-        void evaluate(const pkb::ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const RefType* left,
+        // returns false if the relation can never hold; see ast::Clause::evaluate.
+        bool evaluate(const pkb::ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const RefType* left,
             const RefType* right) const;
     };
 
@@ -54,68 +55,84 @@ namespace pql::eval
         return entry.getStmtNum();
     }
 
+    // variables, procedures and constants all use the same id type.
     template <>
-    inline std::string getEntryValue<std::string>(const table::Entry& entry)
+    inline pkb::ProcId getEntryValue<pkb::ProcId>(const table::Entry& entry)
     {
-        return entry.getVal();
+        return entry.getId();
     }
 
+    // if the relation is given, the join is lazy: its pairs are neither stored nor visited here.
     template <typename LeftRelParam, typename RightRelParam, typename GetAllRelatedToLeftFn>
     void evaluateTwoDeclRelations(const pkb::ProgramKB* pkb, table::Table* table, const ast::RelCond* rel,
-        ast::Declaration* left_decl, ast::Declaration* right_decl, GetAllRelatedToLeftFn&& get_all_related)
+        ast::Declaration* left_decl, ast::Declaration* right_decl, GetAllRelatedToLeftFn&& get_all_related,
+        std::optional<table::JoinRelation> relation = {})
     {
-        auto left_domain = table->getDomain(left_decl);
-        auto right_domain = table->getDomain(right_decl);
+        // a declaration related to itself only ever needs the pairs of equal values, so store those.
+        if(left_decl == right_decl)
+            relation.reset();
+
+        // lazy relations are the ones with many pairs (eg. Next*), so checking each pair against the right side's
+        // domain would cost as much as storing them. only drop the left values without any partner, and estimate
+        // the size from the rows; the solver narrows the right side's domain and counts the actual pairs.
+        if(relation)
+        {
+            size_t estimated_pairs = 0;
+            table->filterDomain(left_decl, [&](const table::Entry& entry) -> bool {
+                decltype(auto) all_related = get_all_related(getEntryValue<LeftRelParam>(entry));
+                estimated_pairs += all_related.size();
+                return !all_related.empty();
+            });
+
+            util::logfmt("pql::eval", "{} adds a lazy join of at most {} pairs", rel->toString(), estimated_pairs);
+            table->addJoin(table::Join(left_decl, right_decl, std::move(*relation), estimated_pairs));
+            return;
+        }
 
         auto new_right_domain = table::Domain {};
         std::unordered_set<std::pair<table::Entry, table::Entry>> join_pairs;
 
-        for(auto it = left_domain.begin(); it != left_domain.end();)
-        {
-            decltype(auto) all_related = get_all_related(getEntryValue<LeftRelParam>(*it));
+        // only the left side is iterated (and filtered in place), so the right side's domain does not need to
+        // be built. if both sides are the same declaration though, the right side must be checked against the
+        // domain as it was before filtering.
+        std::optional<table::Domain> old_domain {};
+        if(left_decl == right_decl)
+            old_domain = table->getDomain(left_decl);
 
+        table->filterDomain(left_decl, [&](const table::Entry& entry) -> bool {
+            decltype(auto) all_related = get_all_related(getEntryValue<LeftRelParam>(entry));
             if(all_related.empty())
-            {
-                it = left_domain.erase(it);
-                continue;
-            }
+                return false;
 
             // special case when both decls contain the same thing.
             if constexpr(std::is_same_v<LeftRelParam, RightRelParam>)
             {
-                if(left_decl == right_decl && all_related.count(getEntryValue<LeftRelParam>(*it)) == 0)
-                {
-                    it = left_domain.erase(it);
-                    continue;
-                }
+                if(left_decl == right_decl && all_related.count(getEntryValue<LeftRelParam>(entry)) == 0)
+                    return false;
             }
 
             bool have_valid_rhs = false;
 
-            auto left_entry = table::Entry(left_decl, getEntryValue<LeftRelParam>(*it));
+            auto left_entry = table::Entry(left_decl, getEntryValue<LeftRelParam>(entry));
             for(const auto& right_value : all_related)
             {
                 auto right_entry = table::Entry(right_decl, right_value);
-                if(right_domain.count(right_entry) == 0)
+                if(old_domain ? old_domain->count(right_entry) == 0 : !table->domainContains(right_decl, right_entry))
                     continue;
 
                 util::logfmt("pql::eval", "{} adds Join({}, {})", rel->toString(), left_entry.toString(),
                     right_entry.toString());
 
                 join_pairs.insert({ left_entry, right_entry });
+
                 new_right_domain.insert(right_entry);
                 have_valid_rhs = true;
             }
 
-            if(have_valid_rhs)
-                ++it;
-            else
-                it = left_domain.erase(it);
-        }
+            return have_valid_rhs;
+        });
 
-        table->putDomain(left_decl, std::move(left_domain));
         table->putDomain(right_decl, std::move(new_right_domain));
-
         table->addJoin(table::Join(left_decl, right_decl, std::move(join_pairs)));
     }
 
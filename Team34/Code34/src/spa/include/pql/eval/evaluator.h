@@ -6,6 +6,7 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "pkb.h"
 #include "pql/parser/ast.h"
@@ -16,24 +17,34 @@ namespace pql::eval
 {
     ast::DESIGN_ENT getDesignEnt(const simple::ast::Stmt* stmt);
 
+    // order the clauses so that the cheap and selective ones run first, and shrink the domains
+    // before the expensive relations (Affects*, NextBip*, ...) get to them. the order is stable,
+    // so clauses of the same cost stay in the order they were written.
+    std::vector<const ast::Clause*> scheduleClauses(const std::vector<std::unique_ptr<ast::Clause>>& clauses);
+
     class Evaluator
     {
     private:
         const pkb::ProgramKB* m_pkb;
 
         table::Table m_table;
+        table::DeclarationIndices m_decl_indices;
         std::unique_ptr<ast::Query> m_query;
 
         void processDeclarations(const ast::DeclarationList& declaration_list);
 
-        std::unordered_set<table::Entry> getInitialDomainVar(ast::Declaration* declaration);
-        std::unordered_set<table::Entry> getInitialDomainProc(ast::Declaration* declaration);
-        std::unordered_set<table::Entry> getInitialDomainStmt(ast::Declaration* declaration);
-        std::unordered_set<table::Entry> getInitialDomainConst(ast::Declaration* declaration);
-        std::unordered_set<table::Entry> getInitialDomain(ast::Declaration* declaration);
+        std::unordered_set<table::Entry> getInitialDomainVar(const ast::Declaration* declaration);
+        std::unordered_set<table::Entry> getInitialDomainProc(const ast::Declaration* declaration);
+        std::unordered_set<table::Entry> getInitialDomainStmt(const ast::Declaration* declaration);
+        std::unordered_set<table::Entry> getInitialDomainConst(const ast::Declaration* declaration);
+        std::unordered_set<table::Entry> getInitialDomain(const ast::Declaration* declaration);
+        bool isInInitialDomain(const table::Entry& entry) const;
 
     public:
         Evaluator(const pkb::ProgramKB* pkb, std::unique_ptr<ast::Query> query);
+        // writes the rows of the result into the sink, one at a time
+        void evaluate(const table::Table::ResultSink& sink);
+        // collects the rows of the result into a list
         std::list<std::string> evaluate();
     };
 }
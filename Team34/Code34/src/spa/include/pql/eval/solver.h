@@ -10,6 +10,10 @@ namespace pql::eval::solver
 {
     using TableHeaders = std::unordered_set<const ast::Declaration*>;
 
+    // lazy joins with at most this many pairs are stored; looking up a stored pair is cheaper than asking
+    // the pkb, but storing tens of millions of them is not.
+    constexpr size_t MAX_MATERIALISED_PAIRS = 1 << 16;
+
     // Intermediate Row for IntTable
     class IntRow
     {
@@ -42,32 +46,47 @@ namespace pql::eval::solver
         bool operator==(const IntRow& other) const;
     };
 
-    // Intermediate Table for solver
+    // Intermediate Table for solver. it is stored by column: one contiguous array of entries per declaration,
+    // all of the same length, so joins only touch the columns they need.
     class IntTable
     {
     private:
-        util::ArenaVec<IntRow> m_rows;
+        std::vector<const ast::Declaration*> m_decls;
+        std::vector<util::ArenaVec<table::Entry>> m_columns;
         TableHeaders m_headers;
+        size_t m_num_rows;
+
+        size_t getColumnIndex(const ast::Declaration* decl) const;
+        // keep only the given rows, in the given order
+        void keepRows(const std::vector<size_t>& rows);
+        // replace this table with the rows (this_rows[k] ++ other_rows[k]) for every k
+        void joinRows(const IntTable& other, const std::vector<size_t>& this_rows,
+            const std::vector<size_t>& other_rows);
 
     public:
-        IntTable(util::ArenaVec<IntRow> rows, const TableHeaders& headers);
+        IntTable(const util::ArenaVec<IntRow>& rows, const TableHeaders& headers);
+        // columns[i] holds the values of decls[i]; all columns must be of the same length
+        IntTable(std::vector<const ast::Declaration*> decls, std::vector<util::ArenaVec<table::Entry>> columns);
         IntTable();
         bool contains(const ast::Declaration* declaration);
 
+        // Merge with the other table, keeping only rows allowed by the join (O(n + m + |join| + output))
         void mergeAndFilter(const IntTable& other, const table::Join& join);
 
-        // Performs cross product on the rows
+        // Natural join on the shared columns, or the cross product if there are none (O(n + m + output))
         void merge(const IntTable& other);
-        // Performs cross product on the Domain and return a new IntTable (O(N^2))
+        // Performs cross product on the Domain
         void mergeColumn(const ast::Declaration* decl, const table::Domain& domain);
         // Remove columns that are not in the allowed headers
         void filterColumns(const TableHeaders& allowed_headers);
         [[nodiscard]] const TableHeaders& getHeaders() const;
-        [[nodiscard]] const util::ArenaVec<IntRow>& getRows() const;
+        [[nodiscard]] const util::ArenaVec<table::Entry>& getColumn(const ast::Declaration* decl) const;
+        // these build rows out of the columns, so they are not cheap.
+        [[nodiscard]] util::ArenaVec<IntRow> getRows() const;
+        [[nodiscard]] IntRow getRow(size_t i) const;
         void filterRows(const table::Join& join);
+        // remove duplicate rows by sorting them, keeping the rest in order (O(n * columns))
         void dedupRows();
-        const IntRow& getRow(size_t i) const;
-        IntRow& getRowMutable(size_t i);
 
         [[nodiscard]] bool empty() const;
         [[nodiscard]] size_t size() const;
@@ -80,18 +99,47 @@ namespace pql::eval::solver
     class DepGraph
     {
     private:
-        std::vector<table::Join> m_joins;
         std::unordered_map<const ast::Declaration*, int> m_colouring;
         std::unordered_map<const ast::Declaration*, TableHeaders> m_graph;
         void colour_node(const ast::Declaration* s, int colour);
 
     public:
-        DepGraph(const TableHeaders& decls, std::vector<table::Join> joins);
+        DepGraph(const TableHeaders& decls, const std::vector<table::Join>& joins);
 
         [[nodiscard]] std::vector<TableHeaders> getComponents() const;
+        // whether the (connected) component has a cycle; joins of a declaration with itself don't count.
+        [[nodiscard]] bool isCyclic(const std::vector<const ast::Declaration*>& component) const;
+        [[nodiscard]] std::string toString() const;
+    };
+
+    // one step of the plan for merging a component into a single table. the first step of every plan
+    // is a scan of the smallest table; after that, each step either brings in a new declaration's table
+    // through a join (merge), or applies a join between two declarations that are already present (filter).
+    //
+    // cyclic components are instead planned as a generic join, which is only made of binds: the
+    // declarations are bound one at a time, in the order of the steps.
+    struct PlanStep
+    {
+        enum class Kind
+        {
+            kScan,
+            kMerge,
+            kFilter,
+            kBind,
+        };
+
+        Kind kind;
+        const ast::Declaration* decl; // the declaration that is brought in; for filters, one of the join's decls
+        const table::Join* join;      // null for scans and binds
+        double estimated_rows;        // estimated size of the table after this step
+        size_t actual_rows = 0;       // its real size, once the columns no longer needed are dropped (for
+                                      // generic joins, only the last bind knows it)
+
         [[nodiscard]] std::string toString() const;
     };
 
+    using JoinPlan = std::vector<PlanStep>;
+
     // Solver
     class Solver
     {
@@ -101,29 +149,68 @@ namespace pql::eval::solver
         TableHeaders m_return_decls;
         std::vector<IntTable> m_int_tables;
         std::vector<std::vector<const ast::Declaration*>> m_decl_components;
+        std::vector<JoinPlan> m_plans;
         DepGraph m_dep_graph;
 
-        std::vector<table::Join> get_joins(const ast::Declaration* decl) const;
-
-        // trim the domain and allowed entries that are associated with decls
+        // these are indexed by the per-query index of a declaration (see table::getDeclarationIndex).
+        // declarations whose columns are in the same table are in the same set of a union-find, and the
+        // root of each set knows the index of its table (or NO_TABLE).
+        static constexpr size_t NO_TABLE = static_cast<size_t>(-1);
+        std::vector<size_t> m_decl_parents;
+        std::vector<size_t> m_decl_set_sizes;
+        std::vector<size_t> m_set_tables;
+        // the indices (into m_joins) of the joins involving each declaration
+        std::vector<std::vector<size_t>> m_decl_joins;
+
+        size_t find_decl_set(size_t decl_index) const;
+        void union_decl_sets(size_t a, size_t b);
+
+        // semi-join reduction over the join graph (AC-3): drop domain entries that have no partner in some
+        // join, and allowed entries whose values are no longer in the domains, until nothing changes.
         //
-        // all allowed entries should be in the domain and all domain should be in the allowed entries
-        void trim(const TableHeaders& decls);
-        void trim_helper(const ast::Declaration* decls, table::Join& join);
-        size_t get_table_index(const ast::Declaration* decl) const;
+        // afterwards all allowed entries are in the domains and all domains are in the allowed entries,
+        // so an acyclic component never builds rows that are later thrown away.
+        void reduce();
+        // reduce one join against the domains, returning the declarations whose domain shrank
+        std::vector<const ast::Declaration*> reduce_join(table::Join& join);
+        std::vector<const ast::Declaration*> reduce_lazy_join(table::Join& join);
+        // store the pairs of the lazy joins that are small enough (see MAX_MATERIALISED_PAIRS)
+        void materialise_small_joins();
+        // choose the order in which the joins of a component are applied, greedily taking the join
+        // with the smallest estimated result at each step.
+        JoinPlan plan_component(const std::vector<const ast::Declaration*>& component) const;
+        // choose the order in which a cyclic component's declarations are bound, preferring the ones
+        // constrained by the most joins to declarations that are already bound.
+        JoinPlan plan_generic_join(const std::vector<const ast::Declaration*>& component) const;
+        // build a component's table by binding one declaration at a time, intersecting the sorted candidates
+        // from every join to the declarations bound before it. unlike pairwise merges, this never builds rows
+        // that only a later join in a cycle would throw away.
+        IntTable generic_join(const std::vector<const ast::Declaration*>& component, const JoinPlan& plan) const;
         // preprocess by joining tables based on the Joins
         void preprocess_int_table();
-        bool has_table(const ast::Declaration* decl) const;
         std::vector<std::vector<const ast::Declaration*>> sort_components(
             const std::vector<TableHeaders>& components) const;
 
     public:
-        Solver(const std::vector<table::Join>& joins,
-            std::unordered_map<const ast::Declaration*, table::Domain> domains, const TableHeaders& return_decls,
-            const TableHeaders& select_decls);
-        [[nodiscard]] IntTable getRetTbl();
+        // the joins are edited while solving, so they should be moved in
+        Solver(std::vector<table::Join> joins, std::unordered_map<const ast::Declaration*, table::Domain> domains,
+            const TableHeaders& return_decls, const TableHeaders& select_decls);
+        // the tables of the components holding the return declarations, one per component. the result is their
+        // cross product, which is left to the caller to expand (so it only needs the sum of their sizes).
+        [[nodiscard]] std::vector<const IntTable*> getRetTbls() const;
         [[nodiscard]] bool isValid() const;
         [[nodiscard]] std::string toString() const;
+        // the plans that were used to build each component's table, in the order they were executed. a plan
+        // only holds the steps that ran, so it stops at the step that left its table empty (if any).
+        [[nodiscard]] const std::vector<JoinPlan>& getPlans() const;
+        // whether the declaration still has a column in some table; declarations that are projected away, or
+        // that were not given to this solver, don't.
+        [[nodiscard]] bool hasTable(const ast::Declaration* decl) const;
+        // the index of the table holding the declaration's column; declarations merged into the same table share it
+        [[nodiscard]] size_t getTableIndex(const ast::Declaration* decl) const;
+        // the indices of the joins within a component, in order
+        [[nodiscard]] std::vector<size_t> getComponentJoins(
+            const std::vector<const ast::Declaration*>& component) const;
     };
 
 }
@@ -135,13 +222,7 @@ struct std::hash<pql::eval::solver::IntRow>
     {
         size_t seed = 0;
         for(const auto& e : r.getColumns())
-        {
-            util::_hash_combine(seed, util::hash_combine(*e.getDeclaration(), e.getType()));
-            if(e.getType() == pql::eval::table::EntryType::kStmt)
-                util::_hash_combine(seed, e.getStmtNum());
-            else
-                util::_hash_combine(seed, e.getVal());
-        }
+            util::_hash_combine(seed, e);
 
         return seed;
     }
@@ -7,12 +7,17 @@
 #include "pql/parser/ast.h"
 #include "simple/ast.h"
 #include "pkb.h"
+#include "util.h"
 #include <unordered_set>
+#include <type_traits>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <list>
 
 namespace pql::eval::table
 {
-    enum class EntryType
+    enum class EntryType : uint8_t
     {
         kNull = 0,
         kStmt,
@@ -21,28 +26,82 @@ namespace pql::eval::table
         kConst,
     };
 
+    // entries refer to declarations by a small index instead of a pointer. each query has its own mapping,
+    // so the indices stay small, and queries on different threads don't share anything.
+    class DeclarationIndices
+    {
+    private:
+        // index 0 is reserved for entries without a declaration.
+        std::vector<const ast::Declaration*> m_decls { nullptr };
+        uint16_t m_last = 0;
+
+    public:
+        uint16_t indexOf(const ast::Declaration* decl);
+        const ast::Declaration* at(uint16_t index) const;
+        void clear();
+    };
+
+    // makes entries on this thread use the given mapping until the scope ends. scopes can be nested; outside
+    // of any scope, each thread has a mapping of its own.
+    class DeclarationIndexScope
+    {
+    private:
+        DeclarationIndices* m_previous;
+
+    public:
+        explicit DeclarationIndexScope(DeclarationIndices* indices);
+        ~DeclarationIndexScope();
+
+        DeclarationIndexScope(const DeclarationIndexScope&) = delete;
+        DeclarationIndexScope& operator=(const DeclarationIndexScope&) = delete;
+    };
+
+    // these go through the mapping in use on this thread
+    uint16_t getDeclarationIndex(const ast::Declaration* decl);
+    const ast::Declaration* getDeclarationAt(uint16_t index);
+    void resetDeclarationIndices();
+
+    // this is 8 bytes and trivially copyable, so rows, domains and joins of these are cheap to copy and hash.
     class Entry
     {
     private:
-        const pql::ast::Declaration* m_declaration = nullptr;
+        uint16_t m_decl = 0;
         EntryType m_type = EntryType::kNull;
-        std::string m_val {};
-        simple::ast::StatementNum m_stmt_num { 0 };
+        // the statement number for statements, otherwise the pkb id of the variable/procedure/constant.
+        // names are only looked up when the results are printed.
+        uint32_t m_val { 0 };
 
     public:
         Entry() = default;
-        Entry(const pql::ast::Declaration* declaration, const std::string& val);
-        Entry(const pql::ast::Declaration* declaration, const simple::ast::StatementNum& val);
+        // the entry type is determined from the declaration
+        Entry(const pql::ast::Declaration* declaration, size_t val);
         // Only use this for AttrRef as we cannot determine the entry type from the declaration
-        Entry(const pql::ast::Declaration* declaration, const std::string& val, EntryType type);
-        [[nodiscard]] std::string getVal() const;
+        Entry(const pql::ast::Declaration* declaration, size_t val, EntryType type);
+        [[nodiscard]] uint32_t getId() const;
         [[nodiscard]] simple::ast::StatementNum getStmtNum() const;
         [[nodiscard]] EntryType getType() const;
         [[nodiscard]] const ast::Declaration* getDeclaration() const;
+        [[nodiscard]] uint16_t getDeclarationIndex() const;
         [[nodiscard]] std::string toString() const;
-        bool operator==(const Entry& other) const;
-        bool operator!=(const Entry& other) const;
+
+        bool operator==(const Entry& other) const
+        {
+            return m_decl == other.m_decl && m_type == other.m_type && m_val == other.m_val;
+        }
+        bool operator!=(const Entry& other) const
+        {
+            return !(*this == other);
+        }
+
+        // the whole entry as one integer, for hashing
+        [[nodiscard]] uint64_t getKey() const
+        {
+            return (uint64_t(m_decl) << 48) | (uint64_t(m_type) << 32) | m_val;
+        }
     };
+
+    static_assert(sizeof(Entry) == 8);
+    static_assert(std::is_trivially_copyable_v<Entry>);
 }
 
 template <>
@@ -50,10 +109,11 @@ struct std::hash<pql::eval::table::Entry>
 {
     size_t operator()(const pql::eval::table::Entry& e) const
     {
-        if(e.getType() == pql::eval::table::EntryType::kStmt)
-            return util::hash_combine(e.getStmtNum(), *e.getDeclaration(), e.getType());
-        else
-            return util::hash_combine(e.getVal(), *e.getDeclaration(), e.getType());
+        // std::hash of an integer is the identity, so mix the bits (this is the splitmix64 finaliser)
+        uint64_t x = e.getKey();
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
     }
 };
 template <>
@@ -101,15 +161,34 @@ namespace pql::eval::table
 
     constexpr auto entry_set_intersect = setIntersction<Entry>;
 
+    // a relation between the values of two declarations that is checked and enumerated through the pkb,
+    // instead of being stored as pairs.
+    struct JoinRelation
+    {
+        std::function<bool(const Entry&, const Entry&)> holds;
+        // the entries of decl_b related to an entry of decl_a, and the other way around
+        std::function<std::vector<Entry>(const Entry&)> forward;
+        std::function<std::vector<Entry>(const Entry&)> reverse;
+    };
+
     // Class representing the dependency between two declaration in a clause.
     // For a table permutation to be valid, the value of m_decl_a,m_decl_b
     // must match one of the value in m_allowed_entries
+    //
+    // relations with many pairs (eg. Next*) can instead be lazy, and only hold the relation itself; then
+    // m_num_pairs is how many pairs there would be. the solver stores the pairs of the small ones anyway.
+    //
+    // the allowed entries can be millions of pairs, so copies of a join share them. they are only copied
+    // if a join is edited while some other copy still holds them; the pipeline moves joins from the table
+    // to the solver, so that should not happen.
     class Join
     {
     private:
         pql::ast::Declaration* m_decl_a;
         pql::ast::Declaration* m_decl_b;
-        std::unordered_set<std::pair<Entry, Entry>> m_allowed_entries;
+        std::shared_ptr<std::unordered_set<std::pair<Entry, Entry>>> m_allowed_entries;
+        std::shared_ptr<const JoinRelation> m_relation;
+        size_t m_num_pairs = 0;
         int m_id;
         static int get_next_id();
 
@@ -117,11 +196,24 @@ namespace pql::eval::table
         Join() = default;
         Join(pql::ast::Declaration* decl_a, pql::ast::Declaration* decl_b,
             std::unordered_set<std::pair<Entry, Entry>> allowed_entries);
-        void setAllowedEntries(const std::unordered_set<std::pair<Entry, Entry>>& allowed_entries);
+        Join(pql::ast::Declaration* decl_a, pql::ast::Declaration* decl_b, JoinRelation relation, size_t num_pairs);
+        void setAllowedEntries(std::unordered_set<std::pair<Entry, Entry>> allowed_entries);
+
+        [[nodiscard]] bool isLazy() const;
+        // the number of allowed entries; for lazy joins, the number there would be.
+        [[nodiscard]] size_t size() const;
+        void setLazySize(size_t num_pairs);
+        // the entries of the other declaration related to the given entry; only for lazy joins.
+        [[nodiscard]] std::vector<Entry> getPartners(const Entry& entry) const;
+        // store the pairs of a lazy join whose entries are in the given domains, making it no longer lazy.
+        void materialise(const Domain& domain_a, const Domain& domain_b);
+
         [[nodiscard]] pql::ast::Declaration* getDeclA() const;
         [[nodiscard]] pql::ast::Declaration* getDeclB() const;
+        // only for joins that are not lazy
         [[nodiscard]] const std::unordered_set<std::pair<Entry, Entry>>& getAllowedEntries() const;
-        [[nodiscard]] std::unordered_set<std::pair<Entry, Entry>>& getAllowedEntries();
+        // the allowed entries of this join alone, copying them first if they are shared with another join
+        [[nodiscard]] std::unordered_set<std::pair<Entry, Entry>>& editAllowedEntries();
         [[nodiscard]] bool isAllowedEntry(const std::pair<Entry, Entry>& entry) const;
         [[nodiscard]] std::string toString() const;
         [[nodiscard]] int getId() const;
@@ -129,42 +221,72 @@ namespace pql::eval::table
 
     class Table
     {
+    public:
+        // builds the full initial domain of a declaration, and checks whether an entry is in it
+        // without having to build it.
+        using DomainInitialiser = std::function<Domain(const ast::Declaration*)>;
+        using DomainMembership = std::function<bool(const Entry&)>;
+        // receives the result one row at a time. the row is only valid during the call, since the buffer
+        // behind it is reused for the next one.
+        using ResultSink = std::function<void(zst::str_view)>;
+
     private:
         std::unordered_map<const ast::Declaration*, Domain> m_domains;
+        // declarations whose initial domain has not been built yet. most clauses narrow a domain
+        // from their own candidates, so a domain is only built if something needs all of it.
+        std::unordered_set<const ast::Declaration*> m_lazy_domains;
+        DomainInitialiser m_domain_initialiser;
+        DomainMembership m_domain_membership;
         // Mapping of <declaration, declaration>: list of corresponding entry
         // All rows must equal to at least one of the entry pair
         std::vector<Join> m_joins;
         // All declaration involved in select query
         std::unordered_set<const ast::Declaration*> m_select_decls;
         // Get mapping of declaration to the join that is involved in.
-        [[nodiscard]] bool hasValidDomain() const;
+        [[nodiscard]] bool hasValidDomain();
+        void buildDomain(const ast::Declaration* decl);
 
     public:
+        void setDomainInitialiser(DomainInitialiser initialiser, DomainMembership membership);
+        // the domain of decl starts out as everything the initialiser gives, but is only built on first use.
+        void declareDomain(const ast::Declaration* decl);
         void putDomain(const ast::Declaration* decl, Domain entries);
-        void addSelectDecl(const ast::Declaration* decl);
-        static Entry extractAttr(const Entry& entry, const ast::AttrRef& attr_ref, const pkb::ProgramKB* pkb);
-        Domain getDomain(const ast::Declaration* decl) const;
-        void addJoin(const Join& join);
+        // intersect the domain of decl with the candidates, without building the domain if it is still lazy.
+        void narrowDomain(const ast::Declaration* decl, Domain candidates);
 
-        using JoinIdSet = std::unordered_set<int>;
-        using DeclSet = std::unordered_set<const ast::Declaration*>;
-        using ValueAssignmentMap = std::unordered_map<const ast::Declaration*, Entry>;
-        using DeclJoinMap = std::unordered_map<const ast::Declaration*, std::vector<const Join*>>;
+        // remove the entries of decl's domain that do not satisfy the predicate, in place.
+        template <typename Predicate>
+        void filterDomain(const ast::Declaration* decl, Predicate&& keep)
+        {
+            this->buildDomain(decl);
 
-        bool evaluateJoinsOverDomains();
+            auto& domain = m_domains[decl];
+            for(auto it = domain.begin(); it != domain.end();)
+            {
+                if(keep(*it))
+                    ++it;
+                else
+                    it = domain.erase(it);
+            }
 
-        bool validateAssignments(ValueAssignmentMap& values, const std::vector<Join>& joins);
+            util::logfmt("pql::eval::table", "Filtered domain of {} to {} entries", decl->toString(), domain.size());
+        }
 
-        bool evaluateJoinValues(ValueAssignmentMap& known, const ast::Declaration* decl, size_t join_idx,
-            const std::vector<const Join*>& joins, JoinIdSet& visited_joins, DeclJoinMap& join_mapping);
+        [[nodiscard]] bool domainContains(const ast::Declaration* decl, const Entry& entry) const;
+        [[nodiscard]] bool hasBuiltDomain(const ast::Declaration* decl) const;
+        void addSelectDecl(const ast::Declaration* decl);
+        static Entry extractAttr(const Entry& entry, const ast::AttrRef& attr_ref, const pkb::ProgramKB* pkb);
+        // builds the domain if it is still lazy. the reference stays valid until the domain is replaced.
+        const Domain& getDomain(const ast::Declaration* decl);
+        void addJoin(Join join);
 
-        bool recursivelyTraverseJoins(ValueAssignmentMap& known, JoinIdSet& visited_joins, const ast::Declaration* decl,
-            DeclJoinMap& join_mapping);
+        // whether there is at least one assignment of values to the select decls that satisfies every join
+        bool evaluateJoinsOverDomains();
 
         Table();
         ~Table();
-        std::list<std::string> getResult(const ast::ResultCl& result, const pkb::ProgramKB* pkb);
-        static std::list<std::string> getFailedResult(const ast::ResultCl& result);
+        void writeResult(const ast::ResultCl& result, const pkb::ProgramKB* pkb, const ResultSink& sink);
+        static void writeFailedResult(const ast::ResultCl& result, const ResultSink& sink);
         [[nodiscard]] std::string toString() const;
     };
 }
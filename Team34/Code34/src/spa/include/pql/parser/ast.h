@@ -228,7 +228,10 @@ namespace pql::ast
     {
         virtual ~Clause();
         virtual std::string toString() const = 0;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const = 0;
+
+        // narrows the domains in the table and adds joins to it. returns false if the clause can
+        // never hold (eg. `Follows(3, 4)` when 4 does not follow 3), in which case the query is false.
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const = 0;
     };
 
     /** Abstract class for Relationship Conditions between Statements and Entities. */
@@ -240,7 +243,7 @@ namespace pql::ast
     struct ModifiesP : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         EntRef modifier {};
         EntRef ent {};
@@ -250,7 +253,7 @@ namespace pql::ast
     struct ModifiesS : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef modifier {};
         EntRef ent {};
@@ -260,7 +263,7 @@ namespace pql::ast
     struct UsesP : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         EntRef user {};
         EntRef ent {};
@@ -270,7 +273,7 @@ namespace pql::ast
     struct UsesS : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef user {};
         EntRef ent {};
@@ -280,7 +283,7 @@ namespace pql::ast
     struct Parent : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef parent {};
         StmtRef child {};
@@ -290,7 +293,7 @@ namespace pql::ast
     struct ParentT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef ancestor {};
         StmtRef descendant {};
@@ -300,7 +303,7 @@ namespace pql::ast
     struct Follows : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef directly_before {};
         StmtRef directly_after {};
@@ -310,7 +313,7 @@ namespace pql::ast
     struct FollowsT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef before {};
         StmtRef after {};
@@ -320,7 +323,7 @@ namespace pql::ast
     struct Calls : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         EntRef caller {};
         EntRef proc {};
@@ -330,7 +333,7 @@ namespace pql::ast
     struct CallsT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         EntRef caller {};
         EntRef proc {};
@@ -339,7 +342,7 @@ namespace pql::ast
     struct Next : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -348,7 +351,7 @@ namespace pql::ast
     struct NextT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -357,7 +360,7 @@ namespace pql::ast
     struct Affects : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -366,7 +369,7 @@ namespace pql::ast
     struct AffectsT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -375,7 +378,7 @@ namespace pql::ast
     struct NextBip : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -384,7 +387,7 @@ namespace pql::ast
     struct NextBipT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -393,7 +396,7 @@ namespace pql::ast
     struct AffectsBip : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -402,7 +405,7 @@ namespace pql::ast
     struct AffectsBipT : RelCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         StmtRef first {};
         StmtRef second {};
@@ -428,7 +431,7 @@ namespace pql::ast
     struct AssignPatternCond : PatternCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         Declaration* assignment_declaration = nullptr;
 
@@ -440,7 +443,7 @@ namespace pql::ast
     struct IfPatternCond : PatternCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         Declaration* if_declaration = nullptr;
         EntRef ent {};
@@ -450,7 +453,7 @@ namespace pql::ast
     struct WhilePatternCond : PatternCond
     {
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
 
         Declaration* while_declaration = nullptr;
         EntRef ent {};
@@ -510,7 +513,7 @@ namespace pql::ast
         WithCondRef rhs {};
 
         virtual std::string toString() const override;
-        virtual void evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
+        virtual bool evaluate(const pkb::ProgramKB* pkb, eval::table::Table* table) const override;
     };
 
     struct ResultCl
@@ -1,3 +1,4 @@
+#include <map>
 #include <chrono>
 #include <string>
 #include <zpr.h>
@@ -25,6 +26,43 @@ namespace bench
 #else
             util::logfmt("TIMER", "{}: function={}; elapsed={}ms", title, fn, elapsed / 1000.0);
 #endif
+#endif
+        }
+    };
+
+    // running totals of things worth counting (allocations, copies, ...), by name, for this thread.
+    // they only ever go up; a CounterScope logs how much each one went up while it was alive.
+    inline std::map<std::string, size_t>& counters()
+    {
+        static thread_local std::map<std::string, size_t> counters {};
+        return counters;
+    }
+
+    inline void count(const char* name, size_t n)
+    {
+        counters()[name] += n;
+    }
+
+    struct CounterScope
+    {
+        std::string title;
+        std::map<std::string, size_t> start;
+        CounterScope(std::string title) : title(std::move(title)), start(counters())
+        {
+        }
+        ~CounterScope()
+        {
+#ifdef ENABLE_BENCHMARK
+            for([[maybe_unused]] const auto& [name, n] : counters())
+            {
+                auto it = start.find(name);
+                [[maybe_unused]] size_t delta = n - (it == start.end() ? 0 : it->second);
+#ifdef BENCHMARK_TO_STDERR
+                zpr::fprintln(stderr, "{}: {}={}", title, name, delta);
+#else
+                util::logfmt("COUNTER", "{}: {}={}", title, name, delta);
+#endif
+            }
 #endif
         }
     };
@@ -33,7 +71,11 @@ namespace bench
 #ifndef ENABLE_BENCHMARK
 static constexpr inline void dummy_fn() { }
 #define START_BENCHMARK_TIMER(...) dummy_fn()
+#define START_BENCHMARK_COUNTERS(...) dummy_fn()
+#define BENCHMARK_COUNT(...) dummy_fn()
 #else
 
 #define START_BENCHMARK_TIMER(title) bench::Timer timer(__FUNCTION__, title)
+#define START_BENCHMARK_COUNTERS(title) bench::CounterScope counter_scope(title)
+#define BENCHMARK_COUNT(name, n) bench::count(name, n)
 #endif
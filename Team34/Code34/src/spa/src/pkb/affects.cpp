@@ -0,0 +1,237 @@
+// affects.cpp
+
+#include "pkb.h"
+#include "exceptions.h"
+
+#include <queue>
+#include <limits>
+#include <vector>
+
+namespace pkb
+{
+    static constexpr size_t NOT_A_DEF = std::numeric_limits<size_t>::max();
+
+    static void check_in_range(StatementNum num, size_t max)
+    {
+        if(num > max || num <= 0)
+            throw util::PkbException("pkb", "StatementNum is out of range");
+    }
+
+    // a reaching definitions analysis over one procedure, where the definitions are the
+    // assignments in the procedure. Affects(a1, a2) holds exactly when the definition at a1
+    // reaches a2 and a2 uses the variable that a1 modifies.
+    void CFG::computeAffects(size_t proc_idx) const
+    {
+        if(m_affects_computed[proc_idx])
+            return;
+
+        auto first = m_procs[proc_idx].first;
+        auto last = m_procs[proc_idx].last;
+        auto num_stmts = last - first + 1;
+
+        std::vector<StatementNum> defs {};
+        std::vector<size_t> def_index(num_stmts, NOT_A_DEF);
+        for(auto s = first; s <= last; s++)
+        {
+            if(getAssignStmtMapping(s) == nullptr)
+                continue;
+
+            def_index[s - first] = defs.size();
+            defs.push_back(s);
+        }
+
+        auto num_defs = defs.size();
+
+        std::unordered_map<VarId, util::BitSet> defs_of_var {};
+        for(size_t d = 0; d < num_defs; d++)
+        {
+            auto var = *getAssignStmtMapping(defs[d])->getModifiedVariableIds().begin();
+            auto it = defs_of_var.try_emplace(var, num_defs).first;
+            it->second.set(d);
+        }
+
+        // reads and calls kill definitions as well, but only assignments generate them.
+        std::vector<util::BitSet> kills(num_stmts);
+        for(auto s = first; s <= last; s++)
+        {
+            auto stmt = getModStmtMapping(s);
+            if(stmt == nullptr)
+                continue;
+
+            kills[s - first] = util::BitSet(num_defs);
+            for(auto var : stmt->getModifiedVariableIds())
+            {
+                if(auto it = defs_of_var.find(var); it != defs_of_var.end())
+                    kills[s - first].unionWith(it->second);
+            }
+        }
+
+        auto transfer = [&](StatementNum s, const util::BitSet& in) -> util::BitSet {
+            auto out = in;
+            out.subtract(kills[s - first]);
+            if(auto d = def_index[s - first]; d != NOT_A_DEF)
+                out.set(d);
+            return out;
+        };
+
+        std::vector<util::BitSet> outs(num_stmts, util::BitSet(num_defs));
+        auto meet = [&](StatementNum s) -> util::BitSet {
+            util::BitSet in(num_defs);
+            for(auto pred : m_prev_graph.targets(s))
+                in.unionWith(outs[pred - first]);
+            return in;
+        };
+
+        std::vector<bool> queued(num_stmts, true);
+        std::queue<StatementNum> worklist {};
+        for(auto s = first; s <= last; s++)
+            worklist.push(s);
+
+        while(!worklist.empty())
+        {
+            auto s = worklist.front();
+            worklist.pop();
+            queued[s - first] = false;
+
+            auto out = transfer(s, meet(s));
+            if(out == outs[s - first])
+                continue;
+
+            outs[s - first] = std::move(out);
+            for(auto succ : m_next_graph.targets(s))
+            {
+                if(!queued[succ - first])
+                {
+                    queued[succ - first] = true;
+                    worklist.push(succ);
+                }
+            }
+        }
+
+        std::vector<StatementSet> affected(num_stmts);
+        std::vector<StatementSet> affecting(num_stmts);
+        for(auto s : defs)
+        {
+            auto in = meet(s);
+            for(auto var : getAssignStmtMapping(s)->getUsedVariableIds())
+            {
+                auto it = defs_of_var.find(var);
+                if(it == defs_of_var.end())
+                    continue;
+
+                auto reaching = in;
+                reaching.intersectWith(it->second);
+                reaching.forEach([&](size_t d) {
+                    affected[defs[d] - first].insert(s);
+                    affecting[s - first].insert(defs[d]);
+                });
+            }
+        }
+
+        for(auto s = first; s <= last; s++)
+        {
+            auto& stmt = m_pkb->getStatementAt(s);
+            stmt.cacheAffectedStatements(std::move(affected[s - first]));
+            stmt.cacheAffectingStatements(std::move(affecting[s - first]));
+        }
+
+        m_affects_computed[proc_idx] = true;
+    }
+
+    void CFG::computeAffectsOf(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+        this->computeAffects(m_stmt_procs[id]);
+    }
+
+    bool CFG::doesAffect(StatementNum id1, StatementNum id2) const
+    {
+        check_in_range(id2, total_inst);
+        return this->getAffectedStatements(id1).count(id2) > 0;
+    }
+
+    void CFG::buildAffectsClosure() const
+    {
+        if(m_affects_closure_built)
+            return;
+
+        std::vector<SparseGraph::Edge> edges {};
+        for(size_t i = 0; i < m_procs.size(); i++)
+        {
+            this->computeAffects(i);
+            for(auto s = m_procs[i].first; s <= m_procs[i].last; s++)
+            {
+                for(auto affected : *m_pkb->getStatementAt(s).maybeGetAffectedStatements())
+                    edges.push_back(SparseGraph::Edge { s, affected, 1 });
+            }
+        }
+
+        auto graph = SparseGraph(total_inst + 1, std::move(edges));
+        m_affects_closure = ReachabilityIndex(graph);
+        m_affected_by_closure = ReachabilityIndex(graph.reversed());
+        m_affects_closure_built = true;
+    }
+
+    bool CFG::doesTransitivelyAffect(StatementNum id1, StatementNum id2) const
+    {
+        check_in_range(id1, total_inst);
+        if(id2 > total_inst || id2 <= 0)
+            return false;
+
+        this->buildAffectsClosure();
+        return m_affects_closure.reaches(id1, id2);
+    }
+
+    bool CFG::affectsRelationExists() const
+    {
+        for(auto [assid, _] : this->assign_stmts)
+        {
+            if(this->getAffectedStatements(assid).size() > 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    const StatementSet& CFG::getAffectedStatements(StatementNum id) const
+    {
+        this->computeAffectsOf(id);
+        return *m_pkb->getStatementAt(id).maybeGetAffectedStatements();
+    }
+
+    const StatementSet& CFG::getAffectingStatements(StatementNum id) const
+    {
+        this->computeAffectsOf(id);
+        return *m_pkb->getStatementAt(id).maybeGetAffectingStatements();
+    }
+
+    const StatementSet& CFG::getTransitivelyAffectedStatements(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+
+        auto& stmt = m_pkb->getStatementAt(id);
+        if(auto cache = stmt.maybeGetTransitivelyAffectedStatements(); cache != nullptr)
+            return *cache;
+
+        this->buildAffectsClosure();
+
+        StatementSet ret {};
+        m_affects_closure.forEachReachable(id, [&ret](size_t s) { ret.insert(s); });
+        return stmt.cacheTransitivelyAffectedStatements(std::move(ret));
+    }
+
+    const StatementSet& CFG::getTransitivelyAffectingStatements(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+
+        auto& stmt = m_pkb->getStatementAt(id);
+        if(auto cache = stmt.maybeGetTransitivelyAffectingStatements(); cache != nullptr)
+            return *cache;
+
+        this->buildAffectsClosure();
+
+        StatementSet ret {};
+        m_affected_by_closure.forEachReachable(id, [&ret](size_t s) { ret.insert(s); });
+        return stmt.cacheTransitivelyAffectingStatements(std::move(ret));
+    }
+}
@@ -0,0 +1,262 @@
+// affects_bip.cpp
+
+#include "pkb.h"
+#include "exceptions.h"
+
+#include <queue>
+#include <vector>
+
+namespace pkb
+{
+    static void check_in_range(StatementNum num, size_t max)
+    {
+        if(num > max || num <= 0)
+            throw util::PkbException("pkb", "StatementNum is out of range");
+    }
+
+    static StatementSet to_statement_set(const util::BitSet& bits)
+    {
+        StatementSet ret {};
+        bits.forEach([&ret](size_t s) { ret.insert(s); });
+        return ret;
+    }
+
+    // propagates the tainted variables through one procedure, starting from the given (statement, taint)
+    // pairs. calls are not entered; the summary of the callee is applied instead. the taint that reaches
+    // the end of the procedure is returned for the caller to deal with, since where it goes next depends
+    // on the call stack.
+    CFG::BipSummary CFG::propagateTaint(AffectsBipEngine& engine, size_t proc_idx,
+        const std::vector<std::pair<StatementNum, util::BitSet>>& seeds) const
+    {
+        auto first = m_procs[proc_idx].first;
+        auto last = m_procs[proc_idx].last;
+        auto num_stmts = last - first + 1;
+
+        BipSummary ret { util::BitSet(m_num_vars), util::BitSet(total_inst + 1) };
+
+        std::vector<util::BitSet> ins(num_stmts, util::BitSet(m_num_vars));
+        std::vector<bool> queued(num_stmts, false);
+        std::queue<StatementNum> worklist {};
+
+        for(auto& [s, taint] : seeds)
+        {
+            ins[s - first].unionWith(taint);
+            if(!queued[s - first])
+            {
+                queued[s - first] = true;
+                worklist.push(s);
+            }
+        }
+
+        while(!worklist.empty())
+        {
+            auto s = worklist.front();
+            worklist.pop();
+            queued[s - first] = false;
+
+            auto out = util::BitSet(m_num_vars);
+            if(auto callee = m_call_targets[s]; callee != NOT_A_CALL)
+            {
+                ins[s - first].forEach([&](size_t var) {
+                    auto& summary = this->getCallSummary(engine, callee, var);
+                    out.unionWith(summary.exit_taint);
+                    ret.affected.unionWith(summary.affected);
+                });
+            }
+            else if(auto var = m_stmt_mod_vars[s]; var != NOT_A_VAR)
+            {
+                out = ins[s - first];
+                out.reset(var);
+
+                // only assignments have used variables here; reads just kill.
+                if(m_stmt_used_vars[s].intersects(ins[s - first]))
+                {
+                    ret.affected.set(s);
+                    if(engine.transitive)
+                        out.set(var);
+                }
+            }
+            else
+            {
+                out = ins[s - first];
+            }
+
+            // a while at the end of the procedure has successors (its body), but the procedure can
+            // still return from it.
+            if(m_exit_stmts[s])
+                ret.exit_taint.unionWith(out);
+
+            auto succs = m_next_graph.targets(s);
+
+            for(auto succ : succs)
+            {
+                if(ins[succ - first].unionWith(out) && !queued[succ - first])
+                {
+                    queued[succ - first] = true;
+                    worklist.push(succ);
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    // what happens when the procedure is called with only `var` tainted.
+    const CFG::BipSummary& CFG::getCallSummary(AffectsBipEngine& engine, size_t proc_idx, size_t var) const
+    {
+        auto key = proc_idx * m_num_vars + var;
+        if(auto it = engine.call_summaries.find(key); it != engine.call_summaries.end())
+            return it->second;
+
+        auto taint = util::BitSet(m_num_vars);
+        taint.set(var);
+
+        auto summary = this->propagateTaint(engine, proc_idx, { { m_procs[proc_idx].first, std::move(taint) } });
+        return engine.call_summaries.emplace(key, std::move(summary)).first->second;
+    }
+
+    // the statements affected after the procedure returns with `var` tainted, when we don't know who called
+    // it -- so every caller is possible. calls with no statement after them don't get a return edge (the
+    // callee returns straight to the caller's caller), so we keep going up in that case. the call graph is
+    // acyclic, so this terminates.
+    const util::BitSet& CFG::getReturnSummary(AffectsBipEngine& engine, size_t proc_idx, size_t var) const
+    {
+        auto key = proc_idx * m_num_vars + var;
+        if(auto it = engine.return_summaries.find(key); it != engine.return_summaries.end())
+            return it->second;
+
+        auto ret = util::BitSet(total_inst + 1);
+        for(auto call : m_proc_callsites[proc_idx])
+        {
+            auto caller = m_stmt_procs[call];
+            auto succs = m_next_graph.targets(call);
+            if(succs.empty())
+            {
+                ret.unionWith(this->getReturnSummary(engine, caller, var));
+                continue;
+            }
+
+            auto taint = util::BitSet(m_num_vars);
+            taint.set(var);
+
+            auto summary = this->propagateTaint(engine, caller, { { succs[0], std::move(taint) } });
+            ret.unionWith(summary.affected);
+            summary.exit_taint.forEach([&](size_t v) { ret.unionWith(this->getReturnSummary(engine, caller, v)); });
+        }
+
+        return engine.return_summaries.emplace(key, std::move(ret)).first->second;
+    }
+
+    StatementSet CFG::computeAffectedBip(AffectsBipEngine& engine, StatementNum id) const
+    {
+        if(getAssignStmtMapping(id) == nullptr)
+            return {};
+
+        auto proc_idx = m_stmt_procs[id];
+        auto var = m_stmt_mod_vars[id];
+
+        std::vector<std::pair<StatementNum, util::BitSet>> seeds {};
+        for(auto succ : m_next_graph.targets(id))
+        {
+            seeds.emplace_back(succ, util::BitSet(m_num_vars));
+            seeds.back().second.set(var);
+        }
+
+        auto summary = this->propagateTaint(engine, proc_idx, seeds);
+        if(seeds.empty())
+            summary.exit_taint.set(var);
+
+        // the statement is not inside any call yet, so returning to any caller is fine.
+        summary.exit_taint.forEach([&](size_t v) { summary.affected.unionWith(this->getReturnSummary(engine, proc_idx, v)); });
+        return to_statement_set(summary.affected);
+    }
+
+    // the reverse relation needs the forward one from every assignment anyway, so compute all of it at once.
+    std::vector<StatementSet> CFG::computeAllAffectingBip(AffectsBipEngine& engine) const
+    {
+        std::vector<StatementSet> affecting(total_inst + 1);
+        for(auto [id, _] : this->assign_stmts)
+        {
+            auto& affected = engine.transitive ? this->getTransitivelyAffectedStatementsBip(id)
+                                               : this->getAffectedStatementsBip(id);
+            for(auto s : affected)
+                affecting[s].insert(id);
+        }
+
+        engine.all_computed = true;
+        return affecting;
+    }
+
+    bool CFG::doesAffectBip(StatementNum id1, StatementNum id2) const
+    {
+        check_in_range(id2, total_inst);
+        return this->getAffectedStatementsBip(id1).count(id2) > 0;
+    }
+
+    bool CFG::doesTransitivelyAffectBip(StatementNum id1, StatementNum id2) const
+    {
+        if(id2 > total_inst || id2 <= 0)
+            return false;
+
+        return this->getTransitivelyAffectedStatementsBip(id1).count(id2) > 0;
+    }
+
+    bool CFG::affectsBipRelationExists() const
+    {
+        for(auto [assid, _] : this->assign_stmts)
+        {
+            if(this->getAffectedStatementsBip(assid).size() > 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    const StatementSet& CFG::getAffectedStatementsBip(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+
+        auto& stmt = m_pkb->getStatementAt(id);
+        if(auto cache = stmt.maybeGetAffectedStatementsBip(); cache != nullptr)
+            return *cache;
+
+        return stmt.cacheAffectedStatementsBip(this->computeAffectedBip(m_affects_bip, id));
+    }
+
+    const StatementSet& CFG::getTransitivelyAffectedStatementsBip(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+
+        auto& stmt = m_pkb->getStatementAt(id);
+        if(auto cache = stmt.maybeGetTransitivelyAffectedStatementsBip(); cache != nullptr)
+            return *cache;
+
+        return stmt.cacheTransitivelyAffectedStatementsBip(this->computeAffectedBip(m_affects_bip_transitive, id));
+    }
+
+    const StatementSet& CFG::getAffectingStatementsBip(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+        if(!m_affects_bip.all_computed)
+        {
+            auto affecting = this->computeAllAffectingBip(m_affects_bip);
+            for(StatementNum s = 1; s <= total_inst; s++)
+                m_pkb->getStatementAt(s).cacheAffectingStatementsBip(std::move(affecting[s]));
+        }
+
+        return *m_pkb->getStatementAt(id).maybeGetAffectingStatementsBip();
+    }
+
+    const StatementSet& CFG::getTransitivelyAffectingStatementsBip(StatementNum id) const
+    {
+        check_in_range(id, total_inst);
+        if(!m_affects_bip_transitive.all_computed)
+        {
+            auto affecting = this->computeAllAffectingBip(m_affects_bip_transitive);
+            for(StatementNum s = 1; s <= total_inst; s++)
+                m_pkb->getStatementAt(s).cacheTransitivelyAffectingStatementsBip(std::move(affecting[s]));
+        }
+
+        return *m_pkb->getStatementAt(id).maybeGetTransitivelyAffectingStatementsBip();
+    }
+}
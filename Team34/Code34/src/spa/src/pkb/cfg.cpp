@@ -5,15 +5,9 @@
 
 #include <zpr.h>
 #include <algorithm>
-#include <queue>
-#include <stack>
-#include <unordered_set>
 #include <vector>
-#include <functional>
 
 
-#define INF SIZE_MAX
-
 namespace pkb
 {
     using StatementNum = simple::ast::StatementNum;
@@ -27,118 +21,92 @@ namespace pkb
     CFG::CFG(const ProgramKB* pkb, size_t v) : m_pkb(pkb)
     {
         total_inst = v;
-        adj_mat = new size_t*[v];
-        adj_mat_bip = new size_t*[v];
-
         m_next_exists = false;
-
-        for(size_t i = 0; i < v; i++)
-        {
-            this->adj_mat[i] = new size_t[v];
-            this->adj_mat_bip[i] = new size_t[v];
-            for(size_t j = 0; j < v; j++)
-            {
-                adj_mat[i][j] = INF;
-                adj_mat_bip[i][j] = INF;
-            }
-        }
-    }
-
-    CFG::~CFG()
-    {
-        for(size_t i = 0; i < total_inst; i++)
-        {
-            delete[] this->adj_mat[i];
-            delete[] this->adj_mat_bip[i];
-        }
-
-        delete[] this->adj_mat;
-        delete[] this->adj_mat_bip;
     }
 
     void CFG::addEdge(StatementNum stmt1, StatementNum stmt2)
     {
         check_in_range(stmt1, total_inst);
         check_in_range(stmt2, total_inst);
-        adj_mat[stmt1 - 1][stmt2 - 1] = 1;
+        m_pending_edges.push_back(SparseGraph::Edge { stmt1, stmt2, 1 });
         m_next_exists = true;
-
-        if(!adj_lst.count(stmt1))
-        {
-            StatementSet stmts { stmt2 };
-            adj_lst[stmt1] = stmts;
-        }
-        else
-        {
-            adj_lst[stmt1].insert(stmt2);
-        }
     }
+
     // weight here refers to edge label + 1
     void CFG::addEdgeBip(StatementNum stmt1, StatementNum stmt2, size_t weight)
     {
         check_in_range(stmt1, total_inst);
         check_in_range(stmt2, total_inst);
         spa_assert(weight != 0);
-        auto pair = std::make_pair(stmt1, stmt2);
-        if(weight == INF) // we are removing edge
+        m_pending_edges_bip.push_back(SparseGraph::Edge { stmt1, stmt2, weight });
+        m_next_bip_exists = true;
+    }
+
+    void CFG::buildNextGraph()
+    {
+        m_stmt_procs.resize(total_inst + 1, 0);
+        for(StatementNum id = 1; id <= total_inst; id++)
         {
-            if(adj_mat_bip[stmt1 - 1][stmt2 - 1] == 0)
-            {
-                bip_ref[pair].erase(weight);
-                if(bip_ref[pair].size() == 1)
-                {
-                    size_t a = *bip_ref[pair].begin();
-                    adj_mat_bip[stmt1 - 1][stmt2 - 1] = a;
-                    bip_ref.erase(pair);
-                }
-            }
-            else if(adj_mat_bip[stmt1 - 1][stmt2 - 1] != INF)
-            {
-                adj_mat_bip[stmt1 - 1][stmt2 - 1] = INF;
-            }
-            if(adj_lst_bip.count(stmt1) != 0)
-            {
-                size_t idx = 0;
-                for(auto a : adj_lst_bip[stmt1])
-                {
-                    if(a.first == stmt2 && a.second == 1)
-                    {
-                        adj_lst_bip[stmt1].erase(adj_lst_bip[stmt1].begin() + idx);
-                        break;
-                    }
-                    idx++;
-                }
-                if(adj_lst_bip[stmt1].size() == 0)
-                {
-                    adj_lst_bip.erase(stmt1);
-                }
-            }
+            auto proc = m_pkb->getStatementAt(id).getProc();
+            if(m_procs.empty() || m_procs.back().proc != proc)
+                m_procs.push_back(ProcRange { proc, id, id });
+
+            m_procs.back().last = id;
+            m_stmt_procs[id] = m_procs.size() - 1;
         }
-        else
+        m_affects_computed.resize(m_procs.size(), false);
+
+        m_next_graph = SparseGraph(total_inst + 1, std::move(m_pending_edges));
+        m_prev_graph = m_next_graph.reversed();
+        m_pending_edges = {};
+
+        // we only ever need to know whether a path exists, not how long it is, so there's no
+        // need for all-pairs shortest paths; the closure over the condensed graph is enough.
+        m_next_closure = ReachabilityIndex(m_next_graph);
+        m_prev_closure = ReachabilityIndex(m_prev_graph);
+    }
+
+    void CFG::buildNextBipGraph()
+    {
+        m_next_bip_graph = SparseGraph(total_inst + 1, std::move(m_pending_edges_bip));
+        m_prev_bip_graph = m_next_bip_graph.reversed();
+        m_pending_edges_bip = {};
+
+        // the only edge out of a call statement is the one into the callee's first statement.
+        m_call_targets.resize(total_inst + 1, NOT_A_CALL);
+        m_proc_callsites.resize(m_procs.size());
+        for(StatementNum id = 1; id <= total_inst; id++)
         {
-            m_next_bip_exists = true;
-            if(adj_mat_bip[stmt1 - 1][stmt2 - 1] == INF)
-            {
-                adj_mat_bip[stmt1 - 1][stmt2 - 1] = weight;
-            }
-            else if(adj_mat_bip[stmt1 - 1][stmt2 - 1] == 0)
-            {
-                bip_ref[pair].insert(weight);
-            }
-            else
-            {
-                bip_ref[pair] = { adj_mat_bip[stmt1 - 1][stmt2 - 1], weight };
-                adj_mat_bip[stmt1 - 1][stmt2 - 1] = 0;
-            }
-            if(adj_lst_bip.count(stmt1) == 0)
-            {
-                std::vector<std::pair<StatementNum, size_t>> stmts { std::make_pair(stmt2, weight) };
-                adj_lst_bip[stmt1] = stmts;
-            }
-            else
-            {
-                adj_lst_bip[stmt1].push_back(std::make_pair(stmt2, weight));
-            }
+            if(getCallStmtMapping(id) == nullptr)
+                continue;
+
+            auto callee = m_stmt_procs[m_next_bip_graph.targets(id)[0]];
+            m_call_targets[id] = callee;
+            m_proc_callsites[callee].push_back(id);
+        }
+
+        m_proc_bodies.resize(m_procs.size());
+        m_proc_returns.resize(m_procs.size());
+        m_proc_entries.resize(m_procs.size());
+        m_next_bip_rows.resize(total_inst + 1);
+        m_prev_bip_rows.resize(total_inst + 1);
+
+        m_num_vars = m_pkb->getNumVariables();
+        m_stmt_mod_vars.resize(total_inst + 1, NOT_A_VAR);
+        m_stmt_used_vars.resize(total_inst + 1);
+        for(StatementNum id = 1; id <= total_inst; id++)
+        {
+            auto stmt = getModStmtMapping(id);
+            if(stmt == nullptr || m_call_targets[id] != NOT_A_CALL)
+                continue;
+
+            m_stmt_mod_vars[id] = *stmt->getModifiedVariableIds().begin();
+            if(getAssignStmtMapping(id) == nullptr)
+                continue;
+
+            m_stmt_used_vars[id] = util::BitSet(m_num_vars);
+            for(auto var : stmt->getUsedVariableIds())
+                m_stmt_used_vars[id].set(var);
         }
     }
 
@@ -152,21 +120,25 @@ namespace pkb
         return m_next_bip_exists;
     }
 
+    // for debugging: 1 dumps the Next* relation, 2 dumps the labels of the NextBip edges.
     std::string CFG::getMatRep(int i) const
     {
-        size_t** mat;
-        switch(i)
-        {
-            case 1:
-                mat = adj_mat;
-                break;
-            case 2:
-                mat = adj_mat_bip;
-                break;
-            default:
-                mat = adj_mat;
-                break;
-        }
+        auto cell = [&](size_t a, size_t b) -> size_t {
+            if(i == 2)
+            {
+                auto tgts = m_next_bip_graph.targets(a);
+                auto lbls = m_next_bip_graph.labels(a);
+                for(size_t k = 0; k < tgts.size(); k++)
+                {
+                    if(tgts[k] == b)
+                        return lbls[k];
+                }
+                return 0;
+            }
+
+            return m_next_closure.reaches(a, b) ? 1 : 0;
+        };
+
         auto res = zpr::sprint("      ");
         for(size_t i = 0; i < total_inst; i++)
         {
@@ -174,12 +146,12 @@ namespace pkb
         }
         res += zpr::sprint("\n");
 
-        for(size_t i = 0; i < total_inst; i++)
+        for(size_t a = 1; a <= total_inst; a++)
         {
-            res += zpr::sprint("{03} | ", i + 1);
-            for(size_t j = 0; j < total_inst; j++)
+            res += zpr::sprint("{03} | ", a);
+            for(size_t b = 1; b <= total_inst; b++)
             {
-                res += zpr::sprint("{03} ", mat[i][j] == INF ? 999 : mat[i][j]);
+                res += zpr::sprint("{03} ", cell(a, b));
             }
             res += zpr::sprint("\n");
         }
@@ -187,23 +159,6 @@ namespace pkb
         return res;
     }
 
-    void CFG::computeDistMat()
-    {
-        // Adapted from https://www.geeksforgeeks.org/floyd-warshall-algorithm-dp-16/
-        for(size_t k = 0; k < total_inst; k++)
-        {
-            for(size_t i = 0; i < total_inst; i++)
-            {
-                for(size_t j = 0; j < total_inst; j++)
-                {
-                    if(adj_mat[i][j] > (adj_mat[i][k] + adj_mat[k][j]) &&
-                        (adj_mat[k][j] != INF && adj_mat[i][k] != INF))
-                        adj_mat[i][j] = adj_mat[i][k] + adj_mat[k][j];
-                }
-            }
-        }
-    }
-
     void CFG::addAssignStmtMapping(StatementNum id, Statement* stmt)
     {
         assign_stmts[id] = stmt;
@@ -246,14 +201,14 @@ namespace pkb
     {
         check_in_range(stmt1, total_inst);
         check_in_range(stmt2, total_inst);
-        return adj_mat[stmt1 - 1][stmt2 - 1] == 1;
+        return m_next_graph.hasEdge(stmt1, stmt2);
     }
 
     bool CFG::isStatementTransitivelyNext(StatementNum stmt1, StatementNum stmt2) const
     {
         check_in_range(stmt1, total_inst);
         check_in_range(stmt2, total_inst);
-        return adj_mat[stmt1 - 1][stmt2 - 1] < INF; // impossible to be 0 since no recursive call
+        return m_next_closure.reaches(stmt1, stmt2);
     }
 
 
@@ -263,11 +218,8 @@ namespace pkb
         if(auto cache = stmt.maybeGetNextStatements(); cache != nullptr)
             return *cache;
 
-        StatementSet ret {};
-        if(auto it = adj_lst.find(id); it != adj_lst.end())
-            ret = it->second;
-
-        return stmt.cacheNextStatements(std::move(ret));
+        auto row = m_next_graph.targets(id);
+        return stmt.cacheNextStatements(StatementSet(row.begin(), row.end()));
     }
 
     const StatementSet& CFG::getTransitivelyNextStatements(StatementNum id) const
@@ -278,11 +230,7 @@ namespace pkb
             return *cache;
 
         StatementSet ret {};
-        for(size_t j = 0; j < total_inst; j++)
-        {
-            if(adj_mat[id - 1][j] < INF)
-                ret.insert(j + 1);
-        }
+        m_next_closure.forEachReachable(id, [&ret](size_t s) { ret.insert(s); });
 
         return stmt.cacheTransitivelyNextStatements(std::move(ret));
     }
@@ -293,14 +241,8 @@ namespace pkb
         if(auto cache = stmt.maybeGetPreviousStatements(); cache != nullptr)
             return *cache;
 
-        StatementSet ret {};
-        for(size_t i = 0; i < this->total_inst; i++)
-        {
-            if(adj_mat[i][id - 1] == 1)
-                ret.insert(i + 1);
-        }
-
-        return stmt.cachePreviousStatements(std::move(ret));
+        auto row = m_prev_graph.targets(id);
+        return stmt.cachePreviousStatements(StatementSet(row.begin(), row.end()));
     }
 
     const StatementSet& CFG::getTransitivelyPreviousStatements(StatementNum id) const
@@ -311,507 +253,128 @@ namespace pkb
             return *cache;
 
         StatementSet ret {};
-        for(size_t i = 0; i < this->total_inst; i++)
-        {
-            if(adj_mat[i][id - 1] < INF)
-                ret.insert(i + 1);
-        }
+        m_prev_closure.forEachReachable(id, [&ret](size_t s) { ret.insert(s); });
 
         return stmt.cacheTransitivelyPreviousStatements(std::move(ret));
     }
 
-    bool CFG::doesAffect(StatementNum id1, StatementNum id2) const
-    {
-        if(!isStatementTransitivelyNext(id1, id2))
-            return false;
-
-        auto stmt1 = getAssignStmtMapping(id1);
-        auto stmt2 = getAssignStmtMapping(id2);
-
-        if(stmt1 == nullptr || stmt2 == nullptr)
-            return false;
-
-        const auto& modified = stmt1->getModifiedVariables();
-        const auto& used = stmt2->getUsedVariables();
-
-        std::string mod_var = *modified.begin();
-        bool is_modified = false;
-        for(const auto& var : used)
-            is_modified |= var == mod_var;
-
-        if(!is_modified)
-            return false;
-
-        StatementSet visited;
-        std::queue<std::pair<StatementNum, std::string>> q;
-        for(auto stmt : adj_lst.at(id1))
-        {
-            q.emplace(stmt, mod_var);
-            visited.insert(stmt);
-        }
-
-        while(!q.empty())
-        {
-            auto [num, var] = q.front();
-            q.pop();
-
-            if(num == id2)
-                return true;
-            if(getModStmtMapping(num) != nullptr && getModStmtMapping(num)->modifiesVariable(var))
-                continue;
-
-            if(auto it = adj_lst.find(num); it != adj_lst.end())
-            {
-                for(auto stmt : it->second)
-                {
-                    if(visited.count(stmt))
-                        continue;
-                    visited.insert(stmt);
-                    q.emplace(stmt, var);
-                }
-            }
-        }
-
-        return false;
-    }
-
-    bool CFG::doesTransitivelyAffect(StatementNum id1, StatementNum id2) const
+    bool CFG::isStatementNextBip(StatementNum stmt1, StatementNum stmt2) const
     {
-        StatementSet visited;
-        std::queue<StatementNum> q;
-        for(auto stmt : getAffectedStatements(id1))
-        {
-            q.push(stmt);
-            visited.insert(stmt);
-        }
-
-        while(!q.empty())
-        {
-            auto num = q.front();
-            q.pop();
-            if(num == id2)
-                return true;
-
-            for(auto stmt : getAffectedStatements(num))
-            {
-                if(visited.count(stmt) == 0)
-                    q.push(stmt);
-                visited.insert(stmt);
-            }
-        }
-        return false;
-    }
-
-    bool CFG::doesAffectBip(StatementNum id1, StatementNum id2) const
-    {
-        if(!isStatementTransitivelyNextBip(id1, id2))
-            return false;
-        auto stmt1 = getAssignStmtMapping(id1);
-        auto stmt2 = getAssignStmtMapping(id2);
-        if(stmt1 == nullptr || stmt2 == nullptr)
-            return false;
-        const auto& modified = stmt1->getModifiedVariables();
-        const auto& used = stmt2->getUsedVariables();
-        std::string mod_var = *modified.begin();
-        bool is_modified = false;
-        for(const auto& var : used)
-            is_modified |= var == mod_var;
-        if(!is_modified)
-            return false;
-
-        std::unordered_map<std::string, std::unordered_set<size_t>> validGates;
-        StatementSet visited;
-        std::stack<StatementNum> emptyStack;
-        bool starting = true;
-
-        std::function<bool(StatementNum, std::stack<StatementNum>)> visit {};
-        visit = [&](StatementNum num, std::stack<StatementNum> callStack) -> bool {
-            if(!starting)
-            {
-                if(num == id2)
-                    return true;
-                if(getCallStmtMapping(num) == nullptr)
-                    if(getModStmtMapping(num) != nullptr && getModStmtMapping(num)->modifiesVariable(mod_var))
-                        return false;
-                visited.insert(num);
-            }
-            else
-            {
-                starting = false;
-            }
-
-            bool ret = false;
-            auto callStmt = getCallStmtMapping(num);
-
-            if(callStmt != nullptr)
-            {
-                auto calleeName = dynamic_cast<const simple::ast::ProcCall*>(callStmt->getAstStmt())->proc_name;
-
-                if(visited.count(gates.at(calleeName).first) == 0) // not visited
-                {
-                    std::stack<StatementNum> calls_copy(callStack);
-                    if(m_pkb->getStatementAt(num).hasFollower())
-                    {
-                        calls_copy.push(num);
-                    }
-                    ret |= visit(gates.at(calleeName).first, calls_copy);
-                }
-                else
-                {
-                    if(validGates.count(calleeName))
-                    {
-                        for(auto return_pt : validGates.at(calleeName))
-                        {
-                            std::stack<StatementNum> calls_copy(callStack);
-                            calls_copy.push(num);
-                            ret |= visit(return_pt, callStack);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                if(auto it = adj_lst_bip.find(num); it != adj_lst_bip.end())
-                {
-                    for(auto& [stmt, weight] : it->second)
-                    {
-                        if(visited.count(stmt) == 0) // not visited yet
-                        {
-                            if(weight == 1)
-                            {
-                                ret |= visit(stmt, callStack);
-                            }
-                            else
-                            {
-                                auto procName = m_pkb->getStatementAt(num).getProc()->name;
-                                if(validGates.count(procName) == 0)
-                                {
-                                    validGates.insert({ procName, { num } });
-                                }
-                                else
-                                {
-                                    validGates[procName].insert(num);
-                                }
-                                if(!callStack.empty())
-                                {
-                                    if(callStack.top() == weight - 1)
-                                    {
-                                        std::stack<StatementNum> calls_copy(callStack);
-                                        calls_copy.pop();
-                                        ret |= visit(stmt, calls_copy);
-                                    }
-                                }
-                                else
-                                {
-                                    ret |= visit(stmt, callStack);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            return ret;
-        };
-
-        return visit(id1, emptyStack);
+        check_in_range(stmt1, total_inst);
+        check_in_range(stmt2, total_inst);
+        return m_next_bip_graph.hasEdge(stmt1, stmt2);
     }
 
-    bool CFG::doesTransitivelyAffectBip(StatementNum id1, StatementNum id2) const
+    // everything that can run once the procedure is called, until it returns.
+    const util::BitSet& CFG::getProcBody(size_t proc_idx) const
     {
-        std::queue<std::pair<StatementNum, std::queue<StatementNum>>> q;
-        for(auto stmt : getAffectedStatementsBip(id1))
-        {
-            std::queue<StatementNum> path;
-            path.push(stmt);
-            q.emplace(stmt, path);
-        }
+        if(auto& cache = m_proc_bodies[proc_idx]; cache.has_value())
+            return *cache;
 
-        while(!q.empty())
+        auto ret = util::BitSet(total_inst + 1);
+        for(auto s = m_procs[proc_idx].first; s <= m_procs[proc_idx].last; s++)
         {
-            auto [num, path] = q.front();
-            q.pop();
-
-            if(num == id2)
-            {
-                if(isValidTransitivelyAffectBip(id1, id2, path))
-                    return true;
-                else
-                    continue;
-            }
-
-            for(auto stmt : getAffectedStatementsBip(num))
-            {
-                std::queue<StatementNum> path_copy(path);
-                path_copy.push(stmt);
-                q.emplace(stmt, path_copy);
-            }
+            ret.set(s);
+            if(auto callee = m_call_targets[s]; callee != NOT_A_CALL)
+                ret.unionWith(this->getProcBody(callee));
         }
 
-        return false;
+        return m_proc_bodies[proc_idx].emplace(std::move(ret));
     }
 
-    bool CFG::isValidTransitivelyAffectBip(StatementNum id1, StatementNum id2, std::queue<StatementNum> path) const
+    // everything reachable once the procedure returns, without knowing which call it returns to. calls
+    // with nothing after them have no return edge (the callee goes straight back to the caller's caller),
+    // so those just continue upwards. the call graph is acyclic, so this terminates.
+    const util::BitSet& CFG::getProcReturns(size_t proc_idx) const
     {
-        std::queue<std::tuple<StatementNum, std::queue<StatementNum>, std::stack<StatementNum>>> q;
-        for(auto [stmt, weight] : adj_lst_bip.at(id1))
-        {
-            std::queue<StatementNum> path_copy(path);
-            std::stack<StatementNum> s;
-            q.emplace(stmt, path_copy, s);
-        }
+        if(auto& cache = m_proc_returns[proc_idx]; cache.has_value())
+            return *cache;
 
-        while(!q.empty())
+        auto ret = util::BitSet(total_inst + 1);
+        for(auto call : m_proc_callsites[proc_idx])
         {
-            auto [num, transits, calls] = q.front();
-            q.pop();
-
-            if(!transits.empty() && transits.front() == num)
-                transits.pop();
-            if(transits.empty())
-                return true;
-
-            if(auto it = adj_lst_bip.find(num); it != adj_lst_bip.end())
+            if(auto succs = m_next_graph.targets(call); !succs.empty())
             {
-                for(auto [stmt, weight] : it->second)
-                {
-                    if(weight == 1)
-                    {
-                        q.emplace(stmt, transits, calls);
-                    }
-                    else
-                    {
-                        if(getCallStmtMapping(num) == nullptr)
-                        {
-                            std::stack<StatementNum> calls_copy(calls);
-                            if(!calls_copy.empty())
-                            {
-                                if(calls.top() == weight)
-                                {
-                                    calls_copy.pop();
-                                    q.emplace(stmt, transits, calls_copy);
-                                }
-                            }
-                            else
-                            {
-                                q.emplace(stmt, transits, calls_copy);
-                            }
-                        }
-                        else
-                        {
-                            std::stack<StatementNum> calls_copy(calls);
-                            calls_copy.push(weight);
-                            q.emplace(stmt, transits, calls_copy);
-                        }
-                    }
-                }
+                ret.set(succs[0]);
+                ret.unionWith(this->getTransitivelyNextInProcBip(succs[0]));
             }
-        }
 
-        return false;
-    }
-
-    bool CFG::affectsRelationExists() const
-    {
-        // TODO: is there a cheaper way of doing this?
-        for(auto [assid, _] : this->assign_stmts)
-        {
-            if(this->getAffectedStatements(assid).size() > 0)
-                return true;
+            ret.unionWith(this->getProcReturns(m_stmt_procs[call]));
         }
 
-        return false;
+        return m_proc_returns[proc_idx].emplace(std::move(ret));
     }
 
-    bool CFG::affectsBipRelationExists() const
+    // everything that can run before the procedure is entered, from any of its callers.
+    const util::BitSet& CFG::getProcEntries(size_t proc_idx) const
     {
-        // TODO: is there a cheaper way of doing this?
-        for(auto [assid, _] : this->assign_stmts)
-        {
-            if(this->getAffectedStatementsBip(assid).size() > 0)
-                return true;
-        }
-
-        return false;
-    }
-
-    const StatementSet& CFG::getAffectedStatements(StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetAffectedStatements(); cache != nullptr)
+        if(auto& cache = m_proc_entries[proc_idx]; cache.has_value())
             return *cache;
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyNextStatements(id))
-            if(doesAffect(id, stmt))
-                ret.insert(stmt);
-
-        return stmt.cacheAffectedStatements(std::move(ret));
-    }
-
-    const StatementSet& CFG::getAffectedStatementsBip(StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetAffectedStatementsBip(); cache != nullptr)
+        auto ret = util::BitSet(total_inst + 1);
+        for(auto call : m_proc_callsites[proc_idx])
         {
-            return *cache;
+            ret.set(call);
+            ret.unionWith(this->getTransitivelyPreviousBipRow(call));
         }
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyNextStatementsBip(id))
-            if(doesAffectBip(id, stmt))
-                ret.insert(stmt);
-
-        return stmt.cacheAffectedStatementsBip(std::move(ret));
+        return m_proc_entries[proc_idx].emplace(std::move(ret));
     }
 
-    const StatementSet& CFG::getAffectingStatements(StatementNum id) const
+    // everything reachable from the statement without returning from its procedure.
+    util::BitSet CFG::getTransitivelyNextInProcBip(StatementNum id) const
     {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetAffectingStatements(); cache != nullptr)
-            return *cache;
-
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyPreviousStatements(id))
-            if(doesAffect(stmt, id))
-                ret.insert(stmt);
-        return stmt.cacheAffectingStatements(std::move(ret));
-    }
+        auto ret = util::BitSet(total_inst + 1);
+        auto add_callee = [&](StatementNum s) {
+            if(auto callee = m_call_targets[s]; callee != NOT_A_CALL)
+                ret.unionWith(this->getProcBody(callee));
+        };
 
-    const StatementSet& CFG::getAffectingStatementsBip(StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetAffectingStatementsBip(); cache != nullptr)
-            return *cache;
+        add_callee(id);
+        m_next_closure.forEachReachable(id, [&](size_t s) {
+            ret.set(s);
+            add_callee(s);
+        });
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyPreviousStatementsBip(id))
-            if(doesAffectBip(stmt, id))
-                ret.insert(stmt);
-        return stmt.cacheAffectingStatementsBip(std::move(ret));
+        return ret;
     }
 
-    const StatementSet& CFG::getTransitivelyAffectedStatements(StatementNum id) const
+    // a NextBip* query can start in the middle of a procedure, in which case we have no idea who called
+    // it; so once the procedure returns, every caller is fair game.
+    const util::BitSet& CFG::getTransitivelyNextBipRow(StatementNum id) const
     {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetTransitivelyAffectedStatements(); cache != nullptr)
+        if(auto& cache = m_next_bip_rows[id]; cache.has_value())
             return *cache;
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyNextStatements(id))
-            if(doesTransitivelyAffect(id, stmt))
-                ret.insert(stmt);
-        return stmt.cacheTransitivelyAffectedStatements(std::move(ret));
-    }
-
-    const StatementSet& CFG::getTransitivelyAffectedStatementsBip(StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetTransitivelyAffectedStatementsBip(); cache != nullptr)
-            return *cache;
+        auto ret = this->getTransitivelyNextInProcBip(id);
+        ret.unionWith(this->getProcReturns(m_stmt_procs[id]));
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyNextStatementsBip(id))
-            if(doesTransitivelyAffectBip(id, stmt))
-                ret.insert(stmt);
-        return stmt.cacheTransitivelyAffectedStatementsBip(std::move(ret));
+        return m_next_bip_rows[id].emplace(std::move(ret));
     }
 
-    const StatementSet& CFG::getTransitivelyAffectingStatements(StatementNum id) const
+    // the reverse works the same way: anything in the procedure that can come before the statement,
+    // the bodies of any calls made there, and whatever could have run before the procedure was entered.
+    const util::BitSet& CFG::getTransitivelyPreviousBipRow(StatementNum id) const
     {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetTransitivelyAffectingStatements(); cache != nullptr)
+        if(auto& cache = m_prev_bip_rows[id]; cache.has_value())
             return *cache;
 
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyPreviousStatements(id))
-            if(doesTransitivelyAffect(stmt, id))
-                ret.insert(stmt);
-        return stmt.cacheTransitivelyAffectingStatements(std::move(ret));
-    }
+        auto ret = util::BitSet(total_inst + 1);
+        m_prev_closure.forEachReachable(id, [&](size_t s) {
+            ret.set(s);
+            if(auto callee = m_call_targets[s]; callee != NOT_A_CALL)
+                ret.unionWith(this->getProcBody(callee));
+        });
 
-    const StatementSet& CFG::getTransitivelyAffectingStatementsBip(StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        if(auto cache = stmt.maybeGetTransitivelyAffectingStatementsBip(); cache != nullptr)
-            return *cache;
-
-        StatementSet ret {};
-        for(auto stmt : getTransitivelyPreviousStatementsBip(id))
-            if(doesTransitivelyAffectBip(stmt, id))
-                ret.insert(stmt);
-        return stmt.cacheTransitivelyAffectingStatementsBip(std::move(ret));
-    }
-
-    bool CFG::isStatementNextBip(StatementNum stmt1, StatementNum stmt2) const
-    {
-        check_in_range(stmt1, total_inst);
-        check_in_range(stmt2, total_inst);
-        return adj_mat_bip[stmt1 - 1][stmt2 - 1] != INF;
-    }
-
-    StatementSet CFG::getCurrentStack(const StatementNum id) const
-    {
-        auto& stmt = m_pkb->getStatementAt(id);
-        StatementSet callStack {};
-
-        auto currProc = stmt.getProc();
-        for(auto& i : m_pkb->maybeGetProcedureNamed(currProc->name)->getAllTransitiveCallers())
-        {
-            auto& callers = m_pkb->getProcedureNamed(i).getCallStmts();
-            callStack.insert(callers.begin(), callers.end());
-        }
-        auto& callers = m_pkb->getProcedureNamed(currProc->name).getCallStmts();
-        callStack.insert(callers.begin(), callers.end());
-        return callStack;
-    }
-
-    void CFG::addNextNodes(
-        StatementNum num, StatementSet& callStack, StatementSet& visited, std::queue<StatementNum>& q) const
-    {
-        auto callStmt = getCallStmtMapping(num);
-        if(callStmt != nullptr)
-        {
-            callStack.insert(num);
-            auto name = dynamic_cast<const simple::ast::ProcCall*>(callStmt->getAstStmt())->proc_name;
-            for(auto return_pt : gates.at(name).second)
-            {
-                q.emplace(return_pt);
-            }
-        }
-        if(auto it = adj_lst_bip.find(num); it != adj_lst_bip.end())
-        {
-            for(auto& [stmt, weight] : it->second)
-            {
-                if(weight == 1 || callStack.count(weight - 1) != 0) // intra or allowed to visit
-                {
-                    if(visited.count(stmt) == 0) // not visited yet
-                    {
-                        q.emplace(stmt);
-                    }
-                }
-            }
-        }
+        ret.unionWith(this->getProcEntries(m_stmt_procs[id]));
+        return m_prev_bip_rows[id].emplace(std::move(ret));
     }
 
     bool CFG::isStatementTransitivelyNextBip(StatementNum id1, StatementNum id2) const
     {
+        check_in_range(id1, total_inst);
         check_in_range(id2, total_inst);
-        StatementSet callStack = getCurrentStack(id1);
-        StatementSet visited;
-        std::queue<StatementNum> q;
-
-        addNextNodes(id1, callStack, visited, q);
-        while(!q.empty())
-        {
-            auto curr = q.front();
-            if(curr == id2)
-                return true;
-            addNextNodes(curr, callStack, visited, q);
-            visited.insert(curr);
-            q.pop();
-        }
-
-        return false;
+        return this->getTransitivelyNextBipRow(id1).test(id2);
     }
 
     const StatementSet& CFG::getNextStatementsBip(StatementNum id) const
@@ -820,37 +383,21 @@ namespace pkb
         if(auto cache = stmt.maybeGetNextStatementsBip(); cache != nullptr)
             return *cache;
 
-        StatementSet ret {};
-        if(auto it = adj_lst_bip.find(id); it != adj_lst_bip.end())
-        {
-            for(auto& pair : it->second)
-            {
-                ret.insert(pair.first);
-            }
-        }
-        return stmt.cacheNextStatementsBip(std::move(ret));
+        auto row = m_next_bip_graph.targets(id);
+        return stmt.cacheNextStatementsBip(StatementSet(row.begin(), row.end()));
     }
 
     const StatementSet& CFG::getTransitivelyNextStatementsBip(StatementNum id) const
     {
-        auto& stmt = m_pkb->getStatementAt(id);
+        check_in_range(id, total_inst);
 
+        auto& stmt = m_pkb->getStatementAt(id);
         if(auto cache = stmt.maybeGetTransitivelyNextStatementsBip(); cache != nullptr)
             return *cache;
 
-        StatementSet callStack = getCurrentStack(id);
-        StatementSet visited;
-        std::queue<StatementNum> q;
-
-        addNextNodes(id, callStack, visited, q);
-        while(!q.empty())
-        {
-            auto curr = q.front();
-            addNextNodes(curr, callStack, visited, q);
-            visited.insert(curr);
-            q.pop();
-        }
-        return stmt.cacheTransitivelyNextStatementsBip(std::move(visited));
+        StatementSet ret {};
+        this->getTransitivelyNextBipRow(id).forEach([&ret](size_t s) { ret.insert(s); });
+        return stmt.cacheTransitivelyNextStatementsBip(std::move(ret));
     }
 
     const StatementSet& CFG::getPreviousStatementsBip(StatementNum id) const
@@ -859,70 +406,20 @@ namespace pkb
         if(auto cache = stmt.maybeGetPreviousStatementsBip(); cache != nullptr)
             return *cache;
 
-        StatementSet ret {};
-        for(size_t i = 0; i < this->total_inst; i++)
-        {
-            if(adj_mat_bip[i][id - 1] < INF)
-                ret.insert(i + 1);
-        }
-
-        return stmt.cachePreviousStatementsBip(std::move(ret));
+        auto row = m_prev_bip_graph.targets(id);
+        return stmt.cachePreviousStatementsBip(StatementSet(row.begin(), row.end()));
     }
 
     const StatementSet& CFG::getTransitivelyPreviousStatementsBip(StatementNum id) const
     {
+        check_in_range(id, total_inst);
+
         auto& stmt = m_pkb->getStatementAt(id);
         if(auto cache = stmt.maybeGetTransitivelyPreviousStatementsBip(); cache != nullptr)
             return *cache;
 
-        StatementSet callStack = getCurrentStack(id);
-        // m_pkb->getProcedureNamed(m_pkb->getStatementAt(id).getProc()->name).getCallStmts()
-        StatementSet visited;
-        std::queue<StatementNum> q;
-
-        auto addPrevNodes = [&](StatementNum id) {
-            std::vector<StatementNum> prevNodes;
-            for(size_t i = 0; i < total_inst; i++)
-            {
-                if(adj_mat_bip[i][id - 1] != INF)
-                {
-                    prevNodes.push_back(i + 1);
-                }
-            }
-            for(auto& prev : prevNodes)
-            {
-                if(visited.count(prev) == 0) // not visited yet
-                {
-                    if(adj_mat_bip[prev - 1][id - 1] == 1) // must be intra and dest cannot be call
-                    {
-                        q.emplace(prev);
-                    }
-                    else
-                    {
-                        if(getCallStmtMapping(prev) == nullptr)
-                        {
-                            callStack.insert(adj_mat_bip[prev - 1][id - 1] - 1);
-                            q.emplace(prev);
-                        }
-
-                        if(callStack.count(adj_mat_bip[prev - 1][id - 1] - 1) != 0)
-                        {
-                            q.emplace(prev);
-                        }
-                    }
-                }
-            }
-        };
-
-        addPrevNodes(id);
-        while(!q.empty())
-        {
-            auto curr = q.front();
-            addPrevNodes(curr);
-            visited.insert(curr);
-            q.pop();
-        }
-
-        return stmt.cacheTransitivelyPreviousStatementsBip(std::move(visited));
+        StatementSet ret {};
+        this->getTransitivelyPreviousBipRow(id).forEach([&ret](size_t s) { ret.insert(s); });
+        return stmt.cacheTransitivelyPreviousStatementsBip(std::move(ret));
     }
 }
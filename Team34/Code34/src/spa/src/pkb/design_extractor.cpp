@@ -61,45 +61,45 @@ namespace pkb
     }
 
 
-    void DesignExtractor::processUses(const std::string& varname, Statement* stmt, const TraversalState& ts)
+    void DesignExtractor::processUses(VarId var_id, Statement* stmt, const TraversalState& ts)
     {
-        stmt->m_uses.insert(varname);
+        stmt->m_uses_ids.insert(var_id);
 
-        auto& var = m_pkb->m_variables[varname];
+        auto& var = *m_pkb->m_variables_by_id[var_id];
 
         // transitively add the modifies
         var.m_used_by.insert(stmt);
         for(auto s : ts.local_stmt_stack)
         {
             var.m_used_by.insert(s);
-            m_pkb->getStatementAt(s->getStmtNum()).m_uses.insert(varname);
+            s->m_uses_ids.insert(var_id);
         }
 
-        var.m_used_by_procs.insert(ts.current_proc->getName());
-        ts.current_proc->m_uses.insert(varname);
+        var.m_used_by_proc_ids.insert(ts.current_proc->m_id);
+        ts.current_proc->m_uses_ids.insert(var_id);
 
         // populate condition_uses for ifs and whiles
         if(auto astmt = stmt->getAstStmt(); CONST_DCAST(WhileLoop, astmt) || CONST_DCAST(IfStmt, astmt))
-            stmt->m_condition_uses.insert(varname);
+            stmt->m_condition_uses_ids.insert(var_id);
     }
 
 
-    void DesignExtractor::processModifies(const std::string& varname, Statement* stmt, const TraversalState& ts)
+    void DesignExtractor::processModifies(VarId var_id, Statement* stmt, const TraversalState& ts)
     {
-        stmt->m_modifies.insert(varname);
+        stmt->m_modifies_ids.insert(var_id);
 
-        auto& var = m_pkb->m_variables[varname];
+        auto& var = *m_pkb->m_variables_by_id[var_id];
 
         // transitively add the modifies
         var.m_modified_by.insert(stmt);
         for(auto s : ts.local_stmt_stack)
         {
             var.m_modified_by.insert(s);
-            m_pkb->getStatementAt(s->getStmtNum()).m_modifies.insert(varname);
+            s->m_modifies_ids.insert(var_id);
         }
 
-        var.m_modified_by_procs.insert(ts.current_proc->getName());
-        ts.current_proc->m_modifies.insert(varname);
+        var.m_modified_by_proc_ids.insert(ts.current_proc->m_id);
+        ts.current_proc->m_modifies_ids.insert(var_id);
     }
 
     void DesignExtractor::processFollowingForStmtList(const s_ast::StmtList* list, TraversalState& ts)
@@ -205,10 +205,10 @@ namespace pkb
 
         // spa_assert(m_visited_procs.find(call_stmt->proc_name) != m_visited_procs.end());
         auto target = &m_pkb->getProcedureNamed(call_stmt->proc_name);
-        for(auto used : target->getUsedVariables())
+        for(auto used : target->getUsedVariableIds())
             processUses(used, stmt, ts);
 
-        for(auto modified : target->getModifiedVariables())
+        for(auto modified : target->getModifiedVariableIds())
             processModifies(modified, stmt, ts);
     }
 
@@ -247,21 +247,21 @@ namespace pkb
             }
             else if(auto assign_stmt = CONST_DCAST(AssignStmt, ast_stmt); assign_stmt)
             {
-                this->processModifies(assign_stmt->lhs, stmt, ts);
+                this->processModifies(m_pkb->getVariableNamed(assign_stmt->lhs).getId(), stmt, ts);
                 this->processExpr(assign_stmt->rhs.get(), stmt, ts);
 
                 m_pkb->m_stmt_kinds[DesignEnt::ASSIGN].insert(sid);
             }
             else if(auto read_stmt = CONST_DCAST(ReadStmt, ast_stmt); read_stmt)
             {
-                this->processModifies(read_stmt->var_name, stmt, ts);
+                this->processModifies(m_pkb->getVariableNamed(read_stmt->var_name).getId(), stmt, ts);
                 m_pkb->getVariableNamed(read_stmt->var_name).m_read_stmts.insert(sid);
 
                 m_pkb->m_stmt_kinds[DesignEnt::READ].insert(sid);
             }
             else if(auto print_stmt = CONST_DCAST(PrintStmt, ast_stmt); print_stmt)
             {
-                this->processUses(print_stmt->var_name, stmt, ts);
+                this->processUses(m_pkb->getVariableNamed(print_stmt->var_name).getId(), stmt, ts);
                 m_pkb->getVariableNamed(print_stmt->var_name).m_print_stmts.insert(sid);
 
                 m_pkb->m_stmt_kinds[DesignEnt::PRINT].insert(sid);
@@ -277,11 +277,11 @@ namespace pkb
     {
         if(auto vr = CONST_DCAST(VarRef, expr); vr)
         {
-            this->processUses(vr->name, stmt, ts);
+            this->processUses(m_pkb->getVariableNamed(vr->name).getId(), stmt, ts);
         }
         else if(auto cnst = CONST_DCAST(Constant, expr); cnst)
         {
-            m_pkb->addConstant(cnst->value);
+            // constants were already collected by assignIds.
         }
         else if(auto binop = CONST_DCAST(BinaryOp, expr); binop)
         {
@@ -356,24 +356,31 @@ namespace pkb
             auto body = &proc.getAstProc()->body;
             this->processCFG(body, 0);
         }
+        this->m_pkb->m_cfg->buildNextGraph();
+
         processBipRelations();
-        // get all shortest paths
-        this->m_pkb->m_cfg->computeDistMat();
+        this->m_pkb->m_cfg->buildNextBipGraph();
     }
 
     void DesignExtractor::processBipRelations()
     {
         auto cfg = this->m_pkb->m_cfg.get();
-        auto adjMat = cfg->adj_mat;
-        for(size_t i = 0; i < cfg->total_inst; i++)
+
+        // every Next edge is also a NextBip edge, except those leaving a call statement; those
+        // are replaced by the call edge into the callee and the return edges out of it.
+        for(StatementNum from = 1; from <= cfg->total_inst; from++)
         {
-            for(size_t j = 0; j < cfg->total_inst; j++)
-            {
-                cfg->addEdgeBip(i + 1, j + 1, adjMat[i][j]);
-            }
+            if(cfg->getCallStmtMapping(from) != nullptr)
+                continue;
+
+            for(auto to : cfg->m_next_graph.targets(from))
+                cfg->addEdgeBip(from, to, 1);
         }
-        // get the return points instead of last stmts
-        auto getLastStmts = [&](const s_ast::StmtList* stmtLst) {
+
+        // get the return points instead of last stmts. a trailing while is a return point too, since the
+        // procedure returns once its condition fails. if enter_calls is false, a trailing call is its own
+        // return point instead of being replaced by the callee's.
+        auto getLastStmts = [&](const s_ast::StmtList* stmtLst, bool enter_calls) {
             std::vector<StatementNum> lastStmts {};
             std::function<void(const s_ast::StmtList*)> visitStmtList {};
             visitStmtList = [&](const s_ast::StmtList* stmtLst) {
@@ -383,7 +390,7 @@ namespace pkb
                     visitStmtList(&stmt->true_case);
                     visitStmtList(&stmt->false_case);
                 }
-                else if(auto stmt = CONST_DCAST(ProcCall, lastStmt); stmt)
+                else if(auto stmt = CONST_DCAST(ProcCall, lastStmt); stmt && enter_calls)
                 {
                     visitStmtList(&m_pkb->getProcedureNamed(stmt->proc_name).getAstProc()->body);
                 }
@@ -396,11 +403,15 @@ namespace pkb
             return lastStmts;
         };
 
+        cfg->m_exit_stmts.resize(cfg->total_inst + 1, false);
         for(auto& [name, proc] : m_pkb->m_procedures)
         {
             auto stmtList = &proc.getAstProc()->body;
-            auto pair = std::make_pair(stmtList->statements.begin()->get()->id, getLastStmts(&proc.getAstProc()->body));
+            auto pair = std::make_pair(stmtList->statements.begin()->get()->id, getLastStmts(stmtList, true));
             cfg->gates.insert({ name, pair });
+
+            for(auto exit : getLastStmts(stmtList, false))
+                cfg->m_exit_stmts[exit] = true;
         }
         for(auto& [name, proc] : m_pkb->m_procedures)
         {
@@ -408,10 +419,6 @@ namespace pkb
             {
                 auto nextStmt = cfg->getNextStatements(callStmt);
                 spa_assert(nextStmt.size() <= 1);
-                if(nextStmt.size() != 0)
-                {
-                    cfg->addEdgeBip(callStmt, *nextStmt.begin(), SIZE_MAX);
-                }
                 auto calledProc = CONST_DCAST(ProcCall, this->m_pkb->getStatementAt(callStmt).getAstStmt())->proc_name;
                 cfg->addEdgeBip(callStmt, cfg->gates.at(calledProc).first, callStmt + 1);
                 // add the return points
@@ -471,13 +478,13 @@ namespace pkb
                         auto target = &m_pkb->getProcedureNamed(c->proc_name);
                         visit(target);
 
-                        proc->m_calls.insert(c->proc_name);
-                        target->m_called_by.insert(proc->getName());
+                        proc->m_calls_ids.insert(target->m_id);
+                        target->m_called_by_ids.insert(proc->m_id);
 
                         // we can do calls_transitive properly here, since we are going *deeper*.
-                        proc->m_calls_transitive.insert(c->proc_name);
-                        proc->m_calls_transitive.insert(
-                            target->m_calls_transitive.begin(), target->m_calls_transitive.end());
+                        proc->m_calls_transitive_ids.insert(target->m_id);
+                        proc->m_calls_transitive_ids.insert(
+                            target->m_calls_transitive_ids.begin(), target->m_calls_transitive_ids.end());
 
                         // called_by_transitive will be done outside, once we have established the
                         // topological order.
@@ -501,12 +508,12 @@ namespace pkb
         for(auto it = topo_order.rbegin(); it != topo_order.rend(); ++it)
         {
             auto proc = *it;
-            for(const auto& _caller : proc->m_called_by)
+            for(auto caller_id : proc->m_called_by_ids)
             {
-                auto* caller = &m_pkb->getProcedureNamed(_caller);
-                proc->m_called_by_transitive.insert(_caller);
-                proc->m_called_by_transitive.insert(
-                    caller->m_called_by_transitive.begin(), caller->m_called_by_transitive.end());
+                auto* caller = m_pkb->m_procedures_by_id[caller_id];
+                proc->m_called_by_transitive_ids.insert(caller_id);
+                proc->m_called_by_transitive_ids.insert(
+                    caller->m_called_by_transitive_ids.begin(), caller->m_called_by_transitive_ids.end());
             }
         }
 
@@ -514,6 +521,89 @@ namespace pkb
     }
 
 
+    static void collect_names(const s_ast::Expr* expr, std::unordered_set<std::string>& var_names, ProgramKB* pkb)
+    {
+        if(auto vr = CONST_DCAST(VarRef, expr); vr)
+        {
+            var_names.insert(vr->name);
+        }
+        else if(auto cnst = CONST_DCAST(Constant, expr); cnst)
+        {
+            pkb->addConstant(cnst->value);
+        }
+        else if(auto binop = CONST_DCAST(BinaryOp, expr); binop)
+        {
+            collect_names(binop->lhs.get(), var_names, pkb);
+            collect_names(binop->rhs.get(), var_names, pkb);
+        }
+        else if(auto unaryop = CONST_DCAST(UnaryOp, expr); unaryop)
+        {
+            collect_names(unaryop->expr.get(), var_names, pkb);
+        }
+    }
+
+    static void collect_names(const s_ast::StmtList* list, std::unordered_set<std::string>& var_names, ProgramKB* pkb)
+    {
+        for(const auto& stmt : list->statements)
+        {
+            if(auto i = CONST_DCAST(IfStmt, stmt.get()); i)
+            {
+                collect_names(i->condition.get(), var_names, pkb);
+                collect_names(&i->true_case, var_names, pkb);
+                collect_names(&i->false_case, var_names, pkb);
+            }
+            else if(auto w = CONST_DCAST(WhileLoop, stmt.get()); w)
+            {
+                collect_names(w->condition.get(), var_names, pkb);
+                collect_names(&w->body, var_names, pkb);
+            }
+            else if(auto a = CONST_DCAST(AssignStmt, stmt.get()); a)
+            {
+                var_names.insert(a->lhs);
+                collect_names(a->rhs.get(), var_names, pkb);
+            }
+            else if(auto r = CONST_DCAST(ReadStmt, stmt.get()); r)
+            {
+                var_names.insert(r->var_name);
+            }
+            else if(auto p = CONST_DCAST(PrintStmt, stmt.get()); p)
+            {
+                var_names.insert(p->var_name);
+            }
+        }
+    }
+
+    // number all the variables, procedures and constants before the relations are extracted, so that those
+    // only ever deal with ids. procedures are numbered in source order, and variables and constants in name
+    // order, so that the ids don't depend on the iteration order of the hash tables.
+    void DesignExtractor::assignIds()
+    {
+        std::unordered_set<std::string> var_name_set {};
+        for(const auto& ast_proc : m_program->procedures)
+        {
+            auto& proc = m_pkb->getProcedureNamed(ast_proc->name);
+            proc.m_id = m_pkb->m_procedures_by_id.size();
+            m_pkb->m_procedures_by_id.push_back(&proc);
+
+            collect_names(&ast_proc->body, var_name_set, m_pkb.get());
+        }
+
+        std::vector<std::string> var_names(var_name_set.begin(), var_name_set.end());
+        std::sort(var_names.begin(), var_names.end());
+        for(auto& name : var_names)
+        {
+            auto& var = m_pkb->m_variables[name];
+            var.m_id = m_pkb->m_variables_by_id.size();
+            var.m_name = std::move(name);
+            m_pkb->m_variables_by_id.push_back(&var);
+        }
+
+        m_pkb->m_constants_by_id.assign(m_pkb->m_constants.begin(), m_pkb->m_constants.end());
+        std::sort(m_pkb->m_constants_by_id.begin(), m_pkb->m_constants_by_id.end());
+        for(ConstId i = 0; i < m_pkb->m_constants_by_id.size(); i++)
+            m_pkb->m_constant_ids.emplace(m_pkb->m_constants_by_id[i], i);
+    }
+
     std::unique_ptr<ProgramKB> DesignExtractor::run()
     {
         START_BENCHMARK_TIMER("design extractor");
@@ -525,6 +615,8 @@ namespace pkb
             this->assignStatementNumbersAndProc(&proc->body, proc.get());
         }
 
+        this->assignIds();
+
         auto topo_order = this->processCallGraph();
         for(auto* proc : topo_order)
         {
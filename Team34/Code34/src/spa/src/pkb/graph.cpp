@@ -0,0 +1,209 @@
+// graph.cpp
+
+#include "pkb.h"
+#include "exceptions.h"
+
+#include <tuple>
+#include <limits>
+#include <algorithm>
+
+namespace pkb
+{
+    static constexpr size_t UNVISITED = std::numeric_limits<size_t>::max();
+
+    SparseGraph::SparseGraph(size_t num_nodes, std::vector<Edge> edges)
+    {
+        std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+            return std::tie(a.from, a.to, a.label) < std::tie(b.from, b.to, b.label);
+        });
+
+        edges.erase(std::unique(edges.begin(), edges.end(),
+                        [](const Edge& a, const Edge& b) {
+                            return a.from == b.from && a.to == b.to && a.label == b.label;
+                        }),
+            edges.end());
+
+        m_offsets.resize(num_nodes + 1, 0);
+        m_targets.reserve(edges.size());
+        m_labels.reserve(edges.size());
+
+        for(auto& e : edges)
+        {
+            spa_assert(e.from < num_nodes && e.to < num_nodes);
+
+            m_offsets[e.from + 1]++;
+            m_targets.push_back(e.to);
+            m_labels.push_back(e.label);
+        }
+
+        for(size_t i = 0; i < num_nodes; i++)
+            m_offsets[i + 1] += m_offsets[i];
+    }
+
+    size_t SparseGraph::size() const
+    {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+
+    size_t SparseGraph::numEdges() const
+    {
+        return m_targets.size();
+    }
+
+    SparseGraph::Row SparseGraph::targets(size_t node) const
+    {
+        spa_assert(node < this->size());
+        return Row { m_targets.data() + m_offsets[node], m_targets.data() + m_offsets[node + 1] };
+    }
+
+    SparseGraph::Row SparseGraph::labels(size_t node) const
+    {
+        spa_assert(node < this->size());
+        return Row { m_labels.data() + m_offsets[node], m_labels.data() + m_offsets[node + 1] };
+    }
+
+    bool SparseGraph::hasEdge(size_t from, size_t to) const
+    {
+        auto row = this->targets(from);
+        return std::binary_search(row.begin(), row.end(), to);
+    }
+
+    SparseGraph SparseGraph::reversed() const
+    {
+        std::vector<Edge> edges {};
+        edges.reserve(this->numEdges());
+
+        for(size_t from = 0; from < this->size(); from++)
+        {
+            for(size_t i = m_offsets[from]; i < m_offsets[from + 1]; i++)
+                edges.push_back(Edge { m_targets[i], from, m_labels[i] });
+        }
+
+        return SparseGraph(this->size(), std::move(edges));
+    }
+
+    ReachabilityIndex::ReachabilityIndex(const SparseGraph& graph)
+    {
+        auto n = graph.size();
+
+        m_components.resize(n, UNVISITED);
+
+        // tarjan's algorithm, but with an explicit call stack -- straight-line procedures with thousands
+        // of statements would otherwise recurse thousands of frames deep. tarjan emits each component only
+        // after every component reachable from it, so the rows of the successors are always ready.
+        std::vector<size_t> index(n, UNVISITED);
+        std::vector<size_t> lowlink(n, 0);
+        std::vector<bool> on_stack(n, false);
+
+        std::vector<size_t> stack {};
+        std::vector<std::pair<size_t, size_t>> call_stack {};
+        size_t counter = 0;
+
+        auto visit = [&](size_t v) {
+            index[v] = counter;
+            lowlink[v] = counter;
+            counter++;
+
+            stack.push_back(v);
+            on_stack[v] = true;
+            call_stack.emplace_back(v, 0);
+        };
+
+        auto emit_component = [&](size_t root) {
+            auto comp = m_rows.size();
+
+            std::vector<size_t> members {};
+            while(true)
+            {
+                auto w = stack.back();
+                stack.pop_back();
+                on_stack[w] = false;
+
+                m_components[w] = comp;
+                members.push_back(w);
+                if(w == root)
+                    break;
+            }
+
+            bool cyclic = members.size() > 1;
+
+            // first pass to find the window of the row, second pass to fill it in.
+            size_t lo = *std::min_element(members.begin(), members.end());
+            size_t hi = *std::max_element(members.begin(), members.end()) + 1;
+            for(auto m : members)
+            {
+                for(auto s : graph.targets(m))
+                {
+                    if(m_components[s] == comp)
+                    {
+                        cyclic |= (s == m);
+                        continue;
+                    }
+
+                    auto& row = m_rows[m_components[s]];
+                    lo = std::min(lo, row.first());
+                    hi = std::max(hi, row.last());
+                }
+            }
+
+            util::BitSet row(lo, hi);
+            for(auto m : members)
+            {
+                row.set(m);
+                for(auto s : graph.targets(m))
+                {
+                    if(m_components[s] != comp)
+                        row.unionWith(m_rows[m_components[s]]);
+                }
+            }
+
+            m_rows.push_back(std::move(row));
+            m_cyclic.push_back(cyclic);
+        };
+
+        for(size_t root = 0; root < n; root++)
+        {
+            if(index[root] != UNVISITED)
+                continue;
+
+            visit(root);
+            while(!call_stack.empty())
+            {
+                auto [v, edge] = call_stack.back();
+                if(edge < graph.targets(v).size())
+                {
+                    call_stack.back().second++;
+
+                    auto w = graph.targets(v)[edge];
+                    if(index[w] == UNVISITED)
+                        visit(w);
+                    else if(on_stack[w])
+                        lowlink[v] = std::min(lowlink[v], index[w]);
+
+                    continue;
+                }
+
+                if(lowlink[v] == index[v])
+                    emit_component(v);
+
+                call_stack.pop_back();
+                if(!call_stack.empty())
+                {
+                    auto parent = call_stack.back().first;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
+                }
+            }
+        }
+    }
+
+    bool ReachabilityIndex::reaches(size_t a, size_t b) const
+    {
+        spa_assert(a < m_components.size() && b < m_components.size());
+
+        auto comp = m_components[a];
+        if(comp == m_components[b])
+            return m_cyclic[comp];
+
+        return m_rows[comp].test(b);
+    }
+}
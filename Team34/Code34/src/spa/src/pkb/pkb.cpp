@@ -75,6 +75,52 @@ namespace pkb
         return nullptr;
     }
 
+    const Variable& ProgramKB::getVariableWithId(const VarId& id) const
+    {
+        if(id >= m_variables_by_id.size())
+            throw util::PkbException("pkb", "no variable with id {}", id);
+
+        return *m_variables_by_id[id];
+    }
+
+    const Procedure& ProgramKB::getProcedureWithId(const ProcId& id) const
+    {
+        if(id >= m_procedures_by_id.size())
+            throw util::PkbException("pkb", "no procedure with id {}", id);
+
+        return *m_procedures_by_id[id];
+    }
+
+    const std::string& ProgramKB::getConstantWithId(const ConstId& id) const
+    {
+        if(id >= m_constants_by_id.size())
+            throw util::PkbException("pkb", "no constant with id {}", id);
+
+        return m_constants_by_id[id];
+    }
+
+    std::optional<ConstId> ProgramKB::maybeGetConstantId(const std::string& value) const
+    {
+        if(auto it = m_constant_ids.find(value); it != m_constant_ids.end())
+            return it->second;
+
+        return std::nullopt;
+    }
+
+    size_t ProgramKB::getNumVariables() const
+    {
+        return m_variables_by_id.size();
+    }
+
+    size_t ProgramKB::getNumProcedures() const
+    {
+        return m_procedures_by_id.size();
+    }
+
+    size_t ProgramKB::getNumConstants() const
+    {
+        return m_constants_by_id.size();
+    }
 
     void ProgramKB::addConstant(std::string value)
     {
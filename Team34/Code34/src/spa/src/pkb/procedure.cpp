@@ -6,78 +6,83 @@ namespace pkb
 {
     Procedure::Procedure(const simple::ast::Procedure* ast_proc) : m_ast_proc(ast_proc) { }
 
-    bool Procedure::usesVariable(const std::string& varname) const
+    const simple::ast::Procedure* Procedure::getAstProc() const
     {
-        return m_uses.count(varname) > 0;
+        return m_ast_proc;
     }
 
-    bool Procedure::modifiesVariable(const std::string& varname) const
+    ProcId Procedure::getId() const
     {
-        return m_modifies.count(varname) > 0;
+        return m_id;
     }
 
-    const simple::ast::Procedure* Procedure::getAstProc() const
+    std::string Procedure::getName() const
     {
-        return m_ast_proc;
+        return m_ast_proc->name;
     }
 
-    const std::unordered_set<std::string>& Procedure::getUsedVariables() const
+    const StatementSet& Procedure::getCallStmts() const
     {
-        return m_uses;
+        return m_call_stmts;
     }
 
-    const std::unordered_set<std::string>& Procedure::getModifiedVariables() const
+    bool Procedure::usesVariable(VarId var) const
     {
-        return m_modifies;
+        return m_uses_ids.count(var) > 0;
     }
 
-    std::string Procedure::getName() const
+    bool Procedure::modifiesVariable(VarId var) const
     {
-        return m_ast_proc->name;
+        return m_modifies_ids.count(var) > 0;
     }
 
-    bool Procedure::callsProcedure(const std::string& procname) const
+    const VarIdSet& Procedure::getUsedVariableIds() const
     {
-        return m_calls.count(procname) > 0;
+        return m_uses_ids;
     }
 
-    bool Procedure::callsProcedureTransitively(const std::string& procname) const
+    const VarIdSet& Procedure::getModifiedVariableIds() const
     {
-        return m_calls_transitive.count(procname) > 0;
+        return m_modifies_ids;
     }
 
-    bool Procedure::isCalledByProcedure(const std::string& procname) const
+    bool Procedure::callsProcedure(ProcId proc) const
     {
-        return m_called_by.count(procname) > 0;
+        return m_calls_ids.count(proc) > 0;
     }
 
-    bool Procedure::isTransitivelyCalledByProcedure(const std::string& procname) const
+    bool Procedure::callsProcedureTransitively(ProcId proc) const
     {
-        return m_called_by_transitive.count(procname) > 0;
+        return m_calls_transitive_ids.count(proc) > 0;
     }
 
-    const std::unordered_set<std::string>& Procedure::getAllCallers() const
+    bool Procedure::isCalledByProcedure(ProcId proc) const
     {
-        return m_called_by;
+        return m_called_by_ids.count(proc) > 0;
     }
 
-    const std::unordered_set<std::string>& Procedure::getAllCalledProcedures() const
+    bool Procedure::isTransitivelyCalledByProcedure(ProcId proc) const
     {
-        return m_calls;
+        return m_called_by_transitive_ids.count(proc) > 0;
     }
 
-    const std::unordered_set<std::string>& Procedure::getAllTransitiveCallers() const
+    const ProcIdSet& Procedure::getAllCallerIds() const
     {
-        return m_called_by_transitive;
+        return m_called_by_ids;
     }
 
-    const std::unordered_set<std::string>& Procedure::getAllTransitivelyCalledProcedures() const
+    const ProcIdSet& Procedure::getAllCalledProcedureIds() const
     {
-        return m_calls_transitive;
+        return m_calls_ids;
     }
 
-    const StatementSet& Procedure::getCallStmts() const
+    const ProcIdSet& Procedure::getAllTransitiveCallerIds() const
     {
-        return m_call_stmts;
+        return m_called_by_transitive_ids;
+    }
+
+    const ProcIdSet& Procedure::getAllTransitivelyCalledProcedureIds() const
+    {
+        return m_calls_transitive_ids;
     }
 }
@@ -67,24 +67,24 @@ namespace pkb
         return m_before;
     }
 
-    bool Statement::usesVariable(const std::string& var_name) const
+    bool Statement::usesVariable(VarId var) const
     {
-        return m_uses.count(var_name) > 0;
+        return m_uses_ids.count(var) > 0;
     }
 
-    bool Statement::modifiesVariable(const std::string& var_name) const
+    bool Statement::modifiesVariable(VarId var) const
     {
-        return m_modifies.count(var_name) > 0;
+        return m_modifies_ids.count(var) > 0;
     }
 
-    const std::unordered_set<std::string>& Statement::getUsedVariables() const
+    const VarIdSet& Statement::getUsedVariableIds() const
     {
-        return m_uses;
+        return m_uses_ids;
     }
 
-    const std::unordered_set<std::string>& Statement::getModifiedVariables() const
+    const VarIdSet& Statement::getModifiedVariableIds() const
     {
-        return m_modifies;
+        return m_modifies_ids;
     }
 
     bool Statement::isParentOf(StatementNum id) const
@@ -128,9 +128,9 @@ namespace pkb
         return m_ancestors;
     }
 
-    const std::unordered_set<std::string>& Statement::getVariablesUsedInCondition() const
+    const VarIdSet& Statement::getVariableIdsUsedInCondition() const
     {
-        return m_condition_uses;
+        return m_condition_uses_ids;
     }
 
 
@@ -66,14 +66,14 @@ namespace pkb
         return ret;
     }
 
-    const std::unordered_set<std::string>& Variable::getUsingProcNames() const
+    const ProcIdSet& Variable::getUsingProcIds() const
     {
-        return m_used_by_procs;
+        return m_used_by_proc_ids;
     }
 
-    const std::unordered_set<std::string>& Variable::getModifyingProcNames() const
+    const ProcIdSet& Variable::getModifyingProcIds() const
     {
-        return m_modified_by_procs;
+        return m_modified_by_proc_ids;
     }
 
     const StatementSet& Variable::getReadStmts() const
@@ -85,4 +85,14 @@ namespace pkb
     {
         return m_print_stmts;
     }
+
+    VarId Variable::getId() const
+    {
+        return m_id;
+    }
+
+    const std::string& Variable::getName() const
+    {
+        return m_name;
+    }
 }
@@ -16,7 +16,7 @@ namespace pql::ast
 
     using Abstractor = eval::RelationAbstractor<Statement, StatementNum, StmtRef, /* SetsAreConstRef: */ true>;
 
-    void Affects::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool Affects::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -51,10 +51,10 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 
-    void AffectsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool AffectsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -89,6 +89,6 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 }
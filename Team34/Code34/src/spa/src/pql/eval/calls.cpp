@@ -14,9 +14,9 @@ namespace pql::ast
 
     using PqlException = util::PqlException;
 
-    using Abstractor = eval::RelationAbstractor<Procedure, std::string, EntRef, /* SetsAreConstRef: */ true>;
+    using Abstractor = eval::RelationAbstractor<Procedure, ProcId, EntRef, /* SetsAreConstRef: */ true>;
 
-    void Calls::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool Calls::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -30,31 +30,31 @@ namespace pql::ast
             abs.rightDeclEntity = DESIGN_ENT::PROCEDURE;
 
             abs.relationHolds = [](const ProgramKB* pkb, const Procedure& a, const Procedure& b) -> bool {
-                return a.callsProcedure(b.getName());
+                return a.callsProcedure(b.getId());
             };
 
             abs.inverseRelationHolds = [](const ProgramKB* pkb, const Procedure& a, const Procedure& b) -> bool {
-                return a.isCalledByProcedure(b.getName());
+                return a.isCalledByProcedure(b.getId());
             };
 
             abs.getAllRelated = [](const ProgramKB* pkb, const Procedure& p) -> decltype(auto) {
-                return p.getAllCalledProcedures();
+                return p.getAllCalledProcedureIds();
             };
 
             abs.getAllInverselyRelated = [](const ProgramKB* pkb, const Procedure& p) -> decltype(auto) {
-                return p.getAllCallers();
+                return p.getAllCallerIds();
             };
 
             abs.relationExists = &ProgramKB::callsRelationExists;
-            abs.getEntity = &ProgramKB::getProcedureNamed;
+            abs.getEntity = &ProgramKB::getProcedureWithId;
             return abs;
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->caller, &this->proc);
+        return abs.evaluate(pkb, tbl, this, &this->caller, &this->proc);
     }
 
-    void CallsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool CallsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -68,27 +68,27 @@ namespace pql::ast
             abs.rightDeclEntity = DESIGN_ENT::PROCEDURE;
 
             abs.relationHolds = [](const ProgramKB* pkb, const Procedure& a, const Procedure& b) -> bool {
-                return a.callsProcedureTransitively(b.getName());
+                return a.callsProcedureTransitively(b.getId());
             };
 
             abs.inverseRelationHolds = [](const ProgramKB* pkb, const Procedure& a, const Procedure& b) -> bool {
-                return a.isTransitivelyCalledByProcedure(b.getName());
+                return a.isTransitivelyCalledByProcedure(b.getId());
             };
 
             abs.getAllRelated = [](const ProgramKB* pkb, const Procedure& p) -> decltype(auto) {
-                return p.getAllTransitivelyCalledProcedures();
+                return p.getAllTransitivelyCalledProcedureIds();
             };
 
             abs.getAllInverselyRelated = [](const ProgramKB* pkb, const Procedure& p) -> decltype(auto) {
-                return p.getAllTransitiveCallers();
+                return p.getAllTransitiveCallerIds();
             };
 
             abs.relationExists = &ProgramKB::callsRelationExists;
-            abs.getEntity = &ProgramKB::getProcedureNamed;
+            abs.getEntity = &ProgramKB::getProcedureWithId;
             return abs;
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->caller, &this->proc);
+        return abs.evaluate(pkb, tbl, this, &this->caller, &this->proc);
     }
 }
@@ -21,19 +21,20 @@ namespace pql::eval
         return ref->isStatementId();
     }
 
-    static inline std::string get_concrete_value(const ast::EntRef* ref)
+    // the only entity named by an EntRef here is a procedure.
+    static inline const pkb::Procedure& get_concrete_entity(const pkb::ProgramKB* pkb, const ast::EntRef* ref)
     {
-        return ref->name();
+        return pkb->getProcedureNamed(ref->name());
     }
 
-    static inline pkb::StatementNum get_concrete_value(const ast::StmtRef* ref)
+    static inline const pkb::Statement& get_concrete_entity(const pkb::ProgramKB* pkb, const ast::StmtRef* ref)
     {
-        return ref->id();
+        return pkb->getStatementAt(ref->id());
     }
 
 
     template <typename Entity, typename RelationParam, typename RefType, bool SetsAreConstRef>
-    void RelationAbstractor<Entity, RelationParam, RefType, SetsAreConstRef>::evaluate(const pkb::ProgramKB* pkb,
+    bool RelationAbstractor<Entity, RelationParam, RefType, SetsAreConstRef>::evaluate(const pkb::ProgramKB* pkb,
         table::Table* table, const ast::RelCond* rel, const RefType* leftRef, const RefType* rightRef) const
     {
         if(leftRef->isDeclaration())
@@ -86,42 +87,43 @@ namespace pql::eval
         if(is_concrete(leftRef) && is_concrete(rightRef))
         {
             util::logfmt("pql::eval", "Processing {}(EntRef, EntRef)", this->relationName);
-            auto& left_ = (pkb->*getEntity)(get_concrete_value(leftRef));
-            auto& right_ = (pkb->*getEntity)(get_concrete_value(rightRef));
+            auto& left_ = get_concrete_entity(pkb, leftRef);
+            auto& right_ = get_concrete_entity(pkb, rightRef);
 
             if(!relation_holds(pkb, left_, right_))
-                throw PqlException("pql::eval", "{} always evaluates to false", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} always evaluates to false", rel->toString());
+                return false;
+            }
         }
         else if(is_concrete(leftRef) && rightRef->isDeclaration())
         {
             util::logfmt("pql::eval", "Processing {}(EntRef, Decl)", this->relationName);
-            auto& left_ = (pkb->*getEntity)(get_concrete_value(leftRef));
+            auto& left_ = get_concrete_entity(pkb, leftRef);
+            auto right_decl = rightRef->declaration();
 
-            auto domain = table->getDomain(rightRef->declaration());
-            for(auto it = domain.begin(); it != domain.end();)
+            // if nothing has narrowed the domain yet, start from whatever is related to the left side
+            // instead of building the whole domain just to filter it.
+            if(!table->hasBuiltDomain(right_decl))
             {
-                auto& right_ = (pkb->*getEntity)(getEntryValue<RelationParam>(*it));
-                if(!relation_holds(pkb, left_, right_))
-                    it = domain.erase(it);
-                else
-                    ++it;
+                table::Domain candidates {};
+                for(const auto& value : get_all_related(pkb, left_))
+                    candidates.emplace(right_decl, value);
+
+                table->narrowDomain(right_decl, std::move(candidates));
+                return true;
             }
 
-            table->putDomain(rightRef->declaration(), std::move(domain));
+            table->filterDomain(right_decl, [&](const table::Entry& entry) -> bool {
+                return relation_holds(pkb, left_, (pkb->*getEntity)(getEntryValue<RelationParam>(entry)));
+            });
         }
         else if(leftRef->isDeclaration() && rightRef->isWildcard())
         {
             util::logfmt("pql::eval", "Processing {}(Decl, _)", this->relationName);
-            auto domain = table->getDomain(leftRef->declaration());
-            for(auto it = domain.begin(); it != domain.end();)
-            {
-                auto& left = (pkb->*getEntity)(getEntryValue<RelationParam>(*it));
-                if(get_all_related(pkb, left).empty())
-                    it = domain.erase(it);
-                else
-                    ++it;
-            }
-            table->putDomain(leftRef->declaration(), std::move(domain));
+            table->filterDomain(leftRef->declaration(), [&](const table::Entry& entry) -> bool {
+                return !get_all_related(pkb, (pkb->*getEntity)(getEntryValue<RelationParam>(entry))).empty();
+            });
         }
         else if(leftRef->isDeclaration() && rightRef->isDeclaration())
         {
@@ -130,29 +132,62 @@ namespace pql::eval
             auto left_decl = leftRef->declaration();
             auto right_decl = rightRef->declaration();
 
-            evaluateTwoDeclRelations<RelationParam, RelationParam>(pkb, table, rel, left_decl, right_decl,
-                [&](const RelationParam& p) -> decltype(auto) { return get_all_related(pkb, (pkb->*getEntity)(p)); });
+            // the abstractors are static, and the pkb outlives the query, so the join can keep both around.
+            // it is up to the solver whether the pairs end up being stored.
+            auto entity_of = [this, pkb](const table::Entry& entry) -> const Entity& {
+                return (pkb->*getEntity)(getEntryValue<RelationParam>(entry));
+            };
+
+            auto relation = table::JoinRelation {};
+            relation.holds = [this, pkb, entity_of](const table::Entry& a, const table::Entry& b) -> bool {
+                return this->relationHolds(pkb, entity_of(a), entity_of(b));
+            };
+            relation.forward = [this, pkb, entity_of, right_decl](const table::Entry& a) -> std::vector<table::Entry> {
+                std::vector<table::Entry> ret {};
+                for(const auto& value : this->getAllRelated(pkb, entity_of(a)))
+                    ret.emplace_back(right_decl, value);
+                return ret;
+            };
+            relation.reverse = [this, pkb, entity_of, left_decl](const table::Entry& b) -> std::vector<table::Entry> {
+                std::vector<table::Entry> ret {};
+                for(const auto& value : this->getAllInverselyRelated(pkb, entity_of(b)))
+                    ret.emplace_back(left_decl, value);
+                return ret;
+            };
+
+            evaluateTwoDeclRelations<RelationParam, RelationParam>(
+                pkb, table, rel, left_decl, right_decl,
+                [&](const RelationParam& p) -> decltype(auto) { return get_all_related(pkb, (pkb->*getEntity)(p)); },
+                std::move(relation));
         }
         else if(is_concrete(leftRef) && rightRef->isWildcard())
         {
             util::logfmt("pql::eval", "Processing {}(EntRef, _)", this->relationName);
-            auto& left_ = (pkb->*getEntity)(get_concrete_value(leftRef));
+            auto& left_ = get_concrete_entity(pkb, leftRef);
             if(get_all_related(pkb, left_).empty())
-                throw PqlException("pql::eval", "{} always evaluates to false", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} always evaluates to false", rel->toString());
+                return false;
+            }
         }
         else if(leftRef->isWildcard() && rightRef->isWildcard())
         {
             util::logfmt("pql::eval", "Processing {}(_, _)", this->relationName);
             if(!(pkb->*relationExists)())
-                throw PqlException("pql::eval", "{} always evaluates to false", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} always evaluates to false", rel->toString());
+                return false;
+            }
         }
         else
         {
             throw PqlException("pql::eval", "unreachable: invalid combination of argument types");
         }
+
+        return true;
     }
 
     template struct RelationAbstractor<pkb::Statement, pkb::StatementNum, ast::StmtRef, false>;
     template struct RelationAbstractor<pkb::Statement, pkb::StatementNum, ast::StmtRef, true>;
-    template struct RelationAbstractor<pkb::Procedure, std::string, ast::EntRef, true>;
+    template struct RelationAbstractor<pkb::Procedure, pkb::ProcId, ast::EntRef, true>;
 }
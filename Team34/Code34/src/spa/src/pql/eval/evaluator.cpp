@@ -32,7 +32,107 @@ namespace pql::eval
         throw util::PqlException("pql::eval", "{} does not have a design ent", stmt->toString(1));
     }
 
-    std::unordered_set<table::Entry> Evaluator::getInitialDomainVar(ast::Declaration* declaration)
+    template <typename... Refs>
+    static size_t count_synonyms(const Refs&... refs)
+    {
+        return (static_cast<size_t>(refs.isDeclaration()) + ...);
+    }
+
+    static size_t count_synonyms(const ast::WithCondRef& lhs, const ast::WithCondRef& rhs)
+    {
+        auto is_synonym = [](const ast::WithCondRef& ref) -> size_t {
+            return ref.isAttrRef() || ref.isDeclaration();
+        };
+        return is_synonym(lhs) + is_synonym(rhs);
+    }
+
+    // the rough cost of evaluating a clause, relative to the other kinds of clauses. clauses
+    // that only involve constants get 0 regardless of their kind, since they either fail the
+    // query immediately or do not constrain anything. clauses with one synonym only narrow its
+    // domain, so all of them go before any clause that joins two synonyms; within each of those
+    // two groups, cheaper kinds of clauses go first.
+    static int clause_cost(const ast::Clause* clause)
+    {
+        constexpr int NUM_KINDS = 7;
+        auto rank = [](size_t synonyms, int cost) -> int {
+            if(synonyms == 0)
+                return 0;
+            return synonyms == 1 ? cost : NUM_KINDS + cost;
+        };
+
+        // a with against a literal pins its synonym to (at most) one value, so it goes right after the constants.
+        if(auto w = dynamic_cast<const ast::WithCond*>(clause))
+            return rank(count_synonyms(w->lhs, w->rhs), count_synonyms(w->lhs, w->rhs) == 1 ? 1 : 3);
+
+        // patterns always have the statement synonym, and maybe a variable one.
+        if(auto p = dynamic_cast<const ast::AssignPatternCond*>(clause))
+            return rank(1 + count_synonyms(p->ent), 2);
+        if(auto p = dynamic_cast<const ast::IfPatternCond*>(clause))
+            return rank(1 + count_synonyms(p->ent), 2);
+        if(auto p = dynamic_cast<const ast::WhilePatternCond*>(clause))
+            return rank(1 + count_synonyms(p->ent), 2);
+
+        if(auto r = dynamic_cast<const ast::Follows*>(clause))
+            return rank(count_synonyms(r->directly_before, r->directly_after), 4);
+        if(auto r = dynamic_cast<const ast::Parent*>(clause))
+            return rank(count_synonyms(r->parent, r->child), 4);
+        if(auto r = dynamic_cast<const ast::ModifiesS*>(clause))
+            return rank(count_synonyms(r->modifier, r->ent), 4);
+        if(auto r = dynamic_cast<const ast::ModifiesP*>(clause))
+            return rank(count_synonyms(r->modifier, r->ent), 4);
+        if(auto r = dynamic_cast<const ast::UsesS*>(clause))
+            return rank(count_synonyms(r->user, r->ent), 4);
+        if(auto r = dynamic_cast<const ast::UsesP*>(clause))
+            return rank(count_synonyms(r->user, r->ent), 4);
+        if(auto r = dynamic_cast<const ast::Calls*>(clause))
+            return rank(count_synonyms(r->caller, r->proc), 4);
+        if(auto r = dynamic_cast<const ast::Next*>(clause))
+            return rank(count_synonyms(r->first, r->second), 4);
+
+        if(auto r = dynamic_cast<const ast::FollowsT*>(clause))
+            return rank(count_synonyms(r->before, r->after), 5);
+        if(auto r = dynamic_cast<const ast::ParentT*>(clause))
+            return rank(count_synonyms(r->ancestor, r->descendant), 5);
+        if(auto r = dynamic_cast<const ast::CallsT*>(clause))
+            return rank(count_synonyms(r->caller, r->proc), 5);
+        if(auto r = dynamic_cast<const ast::NextT*>(clause))
+            return rank(count_synonyms(r->first, r->second), 5);
+
+        if(auto r = dynamic_cast<const ast::Affects*>(clause))
+            return rank(count_synonyms(r->first, r->second), 6);
+        if(auto r = dynamic_cast<const ast::NextBip*>(clause))
+            return rank(count_synonyms(r->first, r->second), 6);
+
+        if(auto r = dynamic_cast<const ast::AffectsT*>(clause))
+            return rank(count_synonyms(r->first, r->second), 7);
+        if(auto r = dynamic_cast<const ast::NextBipT*>(clause))
+            return rank(count_synonyms(r->first, r->second), 7);
+        if(auto r = dynamic_cast<const ast::AffectsBip*>(clause))
+            return rank(count_synonyms(r->first, r->second), 7);
+        if(auto r = dynamic_cast<const ast::AffectsBipT*>(clause))
+            return rank(count_synonyms(r->first, r->second), 7);
+
+        throw util::PqlException("pql::eval", "unknown clause {}", clause->toString());
+    }
+
+    std::vector<const ast::Clause*> scheduleClauses(const std::vector<std::unique_ptr<ast::Clause>>& clauses)
+    {
+        std::vector<std::pair<int, const ast::Clause*>> costs {};
+        costs.reserve(clauses.size());
+        for(const auto& clause : clauses)
+            costs.emplace_back(clause_cost(clause.get()), clause.get());
+
+        std::stable_sort(costs.begin(), costs.end(), [](auto& a, auto& b) -> bool { return a.first < b.first; });
+
+        std::vector<const ast::Clause*> ret {};
+        ret.reserve(costs.size());
+        for(const auto& [_, clause] : costs)
+            ret.push_back(clause);
+
+        return ret;
+    }
+
+    std::unordered_set<table::Entry> Evaluator::getInitialDomainVar(const ast::Declaration* declaration)
     {
         std::unordered_set<table::Entry> domain;
         if(declaration->design_ent != ast::DESIGN_ENT::VARIABLE)
@@ -41,16 +141,14 @@ namespace pql::eval
                 "pql::eval", "Cannot get initial domain(var) for non variable declaration {}", declaration->toString());
         }
 
-        auto& var_list = m_pkb->getAllVariables();
-        util::logfmt("pql::eval", "Adding {} variables to {} initial domain", var_list.size(), declaration->toString());
-        for(const auto& [name, var] : var_list)
-        {
-            util::logfmt("pql::eval", "Adding {} to initial var domain", name);
-            domain.insert(table::Entry(declaration, name));
-        }
+        auto num_vars = m_pkb->getNumVariables();
+        util::logfmt("pql::eval", "Adding {} variables to {} initial domain", num_vars, declaration->toString());
+        for(pkb::VarId id = 0; id < num_vars; id++)
+            domain.emplace(declaration, id);
+
         return domain;
     }
-    std::unordered_set<table::Entry> Evaluator::getInitialDomainProc(ast::Declaration* declaration)
+    std::unordered_set<table::Entry> Evaluator::getInitialDomainProc(const ast::Declaration* declaration)
     {
         std::unordered_set<table::Entry> domain;
         if(declaration->design_ent != ast::DESIGN_ENT::PROCEDURE)
@@ -59,17 +157,14 @@ namespace pql::eval
                 declaration->toString());
         }
 
-        auto& proc_list = m_pkb->getAllProcedures();
-        util::logfmt(
-            "pql::eval", "Adding {} procedures to {} initial domain", proc_list.size(), declaration->toString());
-        for(const auto& [name, proc] : proc_list)
-        {
-            util::logfmt("pql::eval", "Adding {} to initial proc domain", name);
-            domain.insert(table::Entry(declaration, name));
-        }
+        auto num_procs = m_pkb->getNumProcedures();
+        util::logfmt("pql::eval", "Adding {} procedures to {} initial domain", num_procs, declaration->toString());
+        for(pkb::ProcId id = 0; id < num_procs; id++)
+            domain.emplace(declaration, id);
+
         return domain;
     }
-    std::unordered_set<table::Entry> Evaluator::getInitialDomainConst(ast::Declaration* declaration)
+    std::unordered_set<table::Entry> Evaluator::getInitialDomainConst(const ast::Declaration* declaration)
     {
         std::unordered_set<table::Entry> domain;
         if(declaration->design_ent != ast::DESIGN_ENT::CONSTANT)
@@ -77,17 +172,14 @@ namespace pql::eval
             throw util::PqlException("pql::eval", "Cannot get initial domain(constant) for non constant declaration {}",
                 declaration->toString());
         }
-        auto& const_list = m_pkb->getAllConstants();
-        util::logfmt(
-            "pql::eval", "Adding {} constants to {} initial domain", const_list.size(), declaration->toString());
-        for(const auto& const_val : const_list)
-        {
-            util::logfmt("pql::eval", "Adding {} to initial proc domain", const_val);
-            domain.insert(table::Entry(declaration, const_val));
-        }
+        auto num_consts = m_pkb->getNumConstants();
+        util::logfmt("pql::eval", "Adding {} constants to {} initial domain", num_consts, declaration->toString());
+        for(pkb::ConstId id = 0; id < num_consts; id++)
+            domain.emplace(declaration, id);
+
         return domain;
     }
-    std::unordered_set<table::Entry> Evaluator::getInitialDomainStmt(ast::Declaration* declaration)
+    std::unordered_set<table::Entry> Evaluator::getInitialDomainStmt(const ast::Declaration* declaration)
     {
         std::unordered_set<table::Entry> domain {};
         const auto& all_stmts = m_pkb->getAllStatementsOfKind(declaration->design_ent);
@@ -97,7 +189,7 @@ namespace pql::eval
         return domain;
     }
 
-    std::unordered_set<table::Entry> Evaluator::getInitialDomain(ast::Declaration* declaration)
+    std::unordered_set<table::Entry> Evaluator::getInitialDomain(const ast::Declaration* declaration)
     {
         util::logfmt("pql::eval", "Getting initial domain for {}", declaration->toString());
 
@@ -114,42 +206,98 @@ namespace pql::eval
             return getInitialDomainStmt(declaration);
     }
 
+    bool Evaluator::isInInitialDomain(const table::Entry& entry) const
+    {
+        auto design_ent = entry.getDeclaration()->design_ent;
+        switch(entry.getType())
+        {
+            case table::EntryType::kVar:
+                return entry.getId() < m_pkb->getNumVariables();
+            case table::EntryType::kProc:
+                return entry.getId() < m_pkb->getNumProcedures();
+            case table::EntryType::kConst:
+                return entry.getId() < m_pkb->getNumConstants();
+            case table::EntryType::kStmt:
+                return m_pkb->getAllStatementsOfKind(design_ent).count(entry.getStmtNum()) > 0;
+            default:
+                return false;
+        }
+    }
+
     void Evaluator::processDeclarations(const ast::DeclarationList& declaration_list)
     {
+        // the domains are only built when a clause (or the result) needs all of them; see Table::getDomain.
+        m_table.setDomainInitialiser(
+            [this](const ast::Declaration* decl) -> table::Domain { return this->getInitialDomain(decl); },
+            [this](const table::Entry& entry) -> bool { return this->isInInitialDomain(entry); });
+
         for(const auto& [_, decl_ptr] : declaration_list.getAllDeclarations())
-            m_table.putDomain(decl_ptr, getInitialDomain(decl_ptr));
+            m_table.declareDomain(decl_ptr);
     }
 
-    std::list<std::string> Evaluator::evaluate()
+    void Evaluator::evaluate(const table::Table::ResultSink& sink)
     {
         START_BENCHMARK_TIMER("PQL Evaluation Timer");
+        START_BENCHMARK_COUNTERS("PQL Evaluation");
         util::logfmt("pql::eval", "Evaluating query: {}", m_query->toString());
 
         if(m_query->isInvalid())
         {
             util::logfmt("pql::eval", "refusing to evaluate; query was semantically invalid");
-            return table::Table::getFailedResult(m_query->select.result);
+            return table::Table::writeFailedResult(m_query->select.result, sink);
         }
 
+        // the entries of this query index its declarations through a mapping of its own. entries from a
+        // previous evaluation are gone by now, so their indices can be reused.
+        table::DeclarationIndexScope decl_index_scope(&m_decl_indices);
+        table::resetDeclarationIndices();
+
         // this should check for exceptions.
         try
         {
+            auto clauses = scheduleClauses(m_query->select.clauses);
+
+            // clauses without synonyms are scheduled first, and they never touch the table. so, run them
+            // before building any domains; if one of them is false, then so is the whole query.
+            auto gate_end = std::find_if(clauses.begin(), clauses.end(),
+                [](const ast::Clause* clause) -> bool { return clause_cost(clause) != 0; });
+            {
+                START_BENCHMARK_TIMER("Evaluate synonym-free clauses");
+                for(auto it = clauses.begin(); it != gate_end; ++it)
+                {
+                    util::logfmt("pql::eval", "Evaluating synonym-free clause {}", (*it)->toString());
+                    if(!(*it)->evaluate(m_pkb, &m_table))
+                        return table::Table::writeFailedResult(m_query->select.result, sink);
+                }
+            }
+
             processDeclarations(m_query->declarations);
             util::logfmt("pql::eval", "Table after initial processing of declaration: {}", m_table.toString());
 
             {
                 START_BENCHMARK_TIMER("Evaluate all clauses");
-                for(const auto& clause : m_query->select.clauses)
-                    clause->evaluate(m_pkb, &m_table);
+                for(auto it = gate_end; it != clauses.end(); ++it)
+                {
+                    util::logfmt("pql::eval", "Evaluating clause {}", (*it)->toString());
+                    if(!(*it)->evaluate(m_pkb, &m_table))
+                        return table::Table::writeFailedResult(m_query->select.result, sink);
+                }
             }
 
             util::logfmt("pql::eval", "Table after processing of such that: {}", m_table.toString());
-            return this->m_table.getResult(m_query->select.result, this->m_pkb);
+            this->m_table.writeResult(m_query->select.result, this->m_pkb, sink);
         }
         catch(const util::Exception& e)
         {
             util::logfmt("pql::eval", "caught exception during evaluation of query: '{}'", e.what());
-            return table::Table::getFailedResult(m_query->select.result);
+            return table::Table::writeFailedResult(m_query->select.result, sink);
         }
     }
+
+    std::list<std::string> Evaluator::evaluate()
+    {
+        std::list<std::string> result {};
+        this->evaluate([&result](zst::str_view row) { result.push_back(row.str()); });
+        return result;
+    }
 }
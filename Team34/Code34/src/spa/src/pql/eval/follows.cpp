@@ -14,7 +14,7 @@ namespace pql::ast
 
     using PqlException = util::PqlException;
 
-    void Follows::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool Follows::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -61,10 +61,10 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->directly_before, &this->directly_after);
+        return abs.evaluate(pkb, tbl, this, &this->directly_before, &this->directly_after);
     }
 
-    void FollowsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool FollowsT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -100,6 +100,6 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->before, &this->after);
+        return abs.evaluate(pkb, tbl, this, &this->before, &this->after);
     }
 }
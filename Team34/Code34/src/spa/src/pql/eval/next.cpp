@@ -15,7 +15,7 @@ namespace pql::ast
     using PqlException = util::PqlException;
 
     using Abstractor = eval::RelationAbstractor<Statement, StatementNum, StmtRef, /* SetsAreConstRef: */ true>;
-    void Next::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool Next::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -50,12 +50,12 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 
 
 
-    void NextT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool NextT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -90,6 +90,6 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 }
@@ -16,7 +16,7 @@ namespace pql::ast
 
     using Abstractor = eval::RelationAbstractor<Statement, StatementNum, StmtRef, /* SetsAreConstRef: */ true>;
 
-    void NextBip::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool NextBip::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -51,11 +51,11 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 
 
-    void NextBipT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool NextBipT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -90,11 +90,11 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 
 
-    void AffectsBip::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool AffectsBip::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -129,11 +129,11 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 
 
-    void AffectsBipT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool AffectsBipT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -168,6 +168,6 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->first, &this->second);
+        return abs.evaluate(pkb, tbl, this, &this->first, &this->second);
     }
 }
\ No newline at end of file
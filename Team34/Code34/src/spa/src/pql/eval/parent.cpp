@@ -16,7 +16,7 @@ namespace pql::ast
 
     using Abstractor = eval::RelationAbstractor<Statement, StatementNum, StmtRef, /* SetsAreConstRef: */ true>;
 
-    void Parent::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool Parent::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -51,10 +51,10 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->parent, &this->child);
+        return abs.evaluate(pkb, tbl, this, &this->parent, &this->child);
     }
 
-    void ParentT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool ParentT::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         spa_assert(pkb);
         spa_assert(tbl);
@@ -89,6 +89,6 @@ namespace pql::ast
         }
         ();
 
-        abs.evaluate(pkb, tbl, this, &this->ancestor, &this->descendant);
+        return abs.evaluate(pkb, tbl, this, &this->ancestor, &this->descendant);
     }
 }
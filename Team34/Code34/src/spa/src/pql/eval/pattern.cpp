@@ -13,7 +13,7 @@ namespace pql::ast
 
     using PqlException = util::PqlException;
 
-    void AssignPatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
+    bool AssignPatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
     {
         const auto& var_ent = this->ent;
         spa_assert(this->assignment_declaration->design_ent == DESIGN_ENT::ASSIGN);
@@ -32,12 +32,10 @@ namespace pql::ast
         // only used if the variable part is a decl.
         auto var_domain = table::Domain {};
 
-        auto domain = tbl->getDomain(this->assignment_declaration);
-        for(auto it = domain.begin(); it != domain.end();)
-        {
+        tbl->filterDomain(this->assignment_declaration, [&](const table::Entry& entry) -> bool {
             bool should_erase = false;
             auto assign_stmt =
-                dynamic_cast<const s_ast::AssignStmt*>(pkb->getStatementAt(it->getStmtNum()).getAstStmt());
+                dynamic_cast<const s_ast::AssignStmt*>(pkb->getStatementAt(entry.getStmtNum()).getAstStmt());
             spa_assert(assign_stmt);
 
             // check the rhs first, since it requires less table operations
@@ -64,23 +62,18 @@ namespace pql::ast
                     // assignment from the domain; however, any valid SIMPLE program has at least one variable,
                     // so in reality this should not be triggered.
                     auto var_decl = var_ent.declaration();
-                    auto var_list = tbl->getDomain(var_decl);
-                    if(var_list.empty())
-                        should_erase |= true;
+                    auto lhs = *pkb->getStatementAt(entry.getStmtNum()).getModifiedVariableIds().begin();
 
-                    bool have_valid_rhs = false;
-                    for(const auto& entry : var_list)
+                    auto var_entry = table::Entry(var_decl, lhs);
+                    if(tbl->domainContains(var_decl, var_entry))
                     {
-                        if(entry.getVal() == assign_stmt->lhs)
-                        {
-                            allowed_entries.emplace(*it, entry);
-                            var_domain.emplace(std::move(entry));
-                            have_valid_rhs = true;
-                        }
+                        allowed_entries.emplace(entry, var_entry);
+                        var_domain.insert(var_entry);
                     }
-
-                    if(!have_valid_rhs)
+                    else
+                    {
                         should_erase |= true;
+                    }
                 }
                 else if(var_ent.isWildcard())
                 {
@@ -92,19 +85,17 @@ namespace pql::ast
                 }
             }
 
-            if(should_erase)
-                it = domain.erase(it);
-            else
-                ++it;
-        }
+            return !should_erase;
+        });
+
         if(var_ent.isDeclaration())
         {
             auto var_decl = var_ent.declaration();
-            tbl->putDomain(var_decl, table::entry_set_intersect(var_domain, tbl->getDomain(var_decl)));
+            tbl->narrowDomain(var_decl, std::move(var_domain));
             tbl->addJoin(table::Join(assignment_declaration, var_decl, std::move(allowed_entries)));
         }
 
-        tbl->putDomain(this->assignment_declaration, std::move(domain));
+        return true;
     }
 
     void evaluate_if_while_pattern(
@@ -121,15 +112,12 @@ namespace pql::ast
         // join pairs are needed in case of `pattern if/while (v, ...)` (two decls)
         std::unordered_set<std::pair<table::Entry, table::Entry>> join_pairs;
 
-        auto domain = tbl->getDomain(stmt_decl);
-
         // only used if the variable part is a decl.
         auto var_domain = table::Domain {};
 
-        for(auto it = domain.begin(); it != domain.end();)
-        {
+        tbl->filterDomain(stmt_decl, [&](const table::Entry& entry) -> bool {
             bool should_erase = false;
-            auto& condition_vars = pkb->getStatementAt(it->getStmtNum()).getVariablesUsedInCondition();
+            auto& condition_vars = pkb->getStatementAt(entry.getStmtNum()).getVariableIdsUsedInCondition();
             if(condition_vars.empty())
                 should_erase |= true;
 
@@ -137,7 +125,8 @@ namespace pql::ast
             {
                 if(var_ent.isName())
                 {
-                    if(condition_vars.count(var_ent.name()) == 0)
+                    auto var = pkb->maybeGetVariableNamed(var_ent.name());
+                    if(var == nullptr || condition_vars.count(var->getId()) == 0)
                         should_erase |= true;
                 }
                 else if(var_ent.isDeclaration())
@@ -145,17 +134,15 @@ namespace pql::ast
                     util::logfmt("pql::eval", "Processing pattern if/while (v, ...)");
 
                     auto var_decl = var_ent.declaration();
-                    auto var_list = tbl->getDomain(var_decl);
-                    if(var_list.empty())
-                        should_erase |= true;
 
                     bool have_valid_rhs = false;
-                    for(auto& entry : var_list)
+                    for(auto var : condition_vars)
                     {
-                        if(condition_vars.count(entry.getVal()) > 0)
+                        auto var_entry = table::Entry(var_decl, var);
+                        if(tbl->domainContains(var_decl, var_entry))
                         {
-                            join_pairs.emplace(*it, entry);       // this one copies
-                            var_domain.emplace(std::move(entry)); // and this one moves
+                            join_pairs.emplace(entry, var_entry);
+                            var_domain.insert(var_entry);
                             have_valid_rhs = true;
                         }
                     }
@@ -173,20 +160,16 @@ namespace pql::ast
                 }
             }
 
-            if(should_erase)
-                it = domain.erase(it);
-            else
-                ++it;
-        }
+            return !should_erase;
+        });
 
         if(var_ent.isDeclaration())
         {
             auto var_decl = var_ent.declaration();
-            tbl->putDomain(var_decl, table::entry_set_intersect(var_domain, tbl->getDomain(var_decl)));
+            tbl->narrowDomain(var_decl, std::move(var_domain));
             tbl->addJoin(table::Join(stmt_decl, var_ent.declaration(), std::move(join_pairs)));
         }
 
-        tbl->putDomain(stmt_decl, std::move(domain));
     }
 
 
@@ -194,19 +177,21 @@ namespace pql::ast
 
 
 
-    void IfPatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
+    bool IfPatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
     {
         const auto& var_ent = this->ent;
         spa_assert(this->if_declaration->design_ent == DESIGN_ENT::IF);
 
         evaluate_if_while_pattern(pkb, tbl, this->if_declaration, var_ent);
+        return true;
     }
 
-    void WhilePatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
+    bool WhilePatternCond::evaluate(const pkb::ProgramKB* pkb, table::Table* tbl) const
     {
         const auto& var_ent = this->ent;
         spa_assert(this->while_declaration->design_ent == DESIGN_ENT::WHILE);
 
         evaluate_if_while_pattern(pkb, tbl, this->while_declaration, var_ent);
+        return true;
     }
 }
@@ -1,7 +1,12 @@
 // solver.cpp
 
+#include <array>
 #include <queue>
+#include <optional>
+#include <unordered_set>
+#include <unordered_map>
 #include <utility>
+#include <limits>
 #include <iterator>
 #include <algorithm>
 
@@ -143,12 +148,13 @@ namespace pql::eval::solver
     }
 
 
-    IntTable::IntTable(util::ArenaVec<IntRow> rows, const TableHeaders& headers)
-        : m_rows(std::move(rows)), m_headers(headers)
+    IntTable::IntTable(const util::ArenaVec<IntRow>& rows, const TableHeaders& headers)
+        : m_decls(headers.begin(), headers.end()), m_columns(headers.size()), m_headers(headers),
+          m_num_rows(rows.size())
     {
         // evaluate this in an assert so it goes away during release
         spa_assert([&]() -> bool {
-            for(const auto& row : m_rows)
+            for(const auto& row : rows)
             {
                 spa_assert(row.size() == headers.size());
                 for(auto& entry : row.getColumns())
@@ -156,11 +162,27 @@ namespace pql::eval::solver
             }
             return true;
         }());
+
+        for(size_t i = 0; i < m_decls.size(); i++)
+        {
+            m_columns[i].reserve(rows.size());
+            for(const auto& row : rows)
+                m_columns[i].push_back(row.getVal(m_decls[i]));
+        }
+    }
+
+    IntTable::IntTable(std::vector<const ast::Declaration*> decls, std::vector<util::ArenaVec<table::Entry>> columns)
+        : m_decls(std::move(decls)), m_columns(std::move(columns)), m_headers(m_decls.begin(), m_decls.end()),
+          m_num_rows(m_columns.empty() ? 1 : m_columns.front().size())
+    {
+        spa_assert(m_decls.size() == m_columns.size());
+        spa_assert(std::all_of(m_columns.begin(), m_columns.end(),
+            [this](const auto& column) -> bool { return column.size() == m_num_rows; }));
     }
 
     IntTable::IntTable()
         : // Initialise empty table with a row with no columns
-          m_rows({ IntRow() }), m_headers()
+          m_decls(), m_columns(), m_headers(), m_num_rows(1)
     {
     }
 
@@ -169,38 +191,150 @@ namespace pql::eval::solver
         return m_headers.count(declaration);
     }
 
-    void IntTable::merge(const IntTable& other)
+    size_t IntTable::getColumnIndex(const ast::Declaration* decl) const
+    {
+        for(size_t i = 0; i < m_decls.size(); i++)
+        {
+            if(m_decls[i] == decl)
+                return i;
+        }
+
+        throw util::PqlException("pql::eval::solver", "{} is not a column of {}", decl->toString(), toString());
+    }
+
+    const util::ArenaVec<table::Entry>& IntTable::getColumn(const ast::Declaration* decl) const
+    {
+        return m_columns[this->getColumnIndex(decl)];
+    }
+
+    static util::ArenaVec<table::Entry> gather(const util::ArenaVec<table::Entry>& column, const std::vector<size_t>& rows)
+    {
+        util::ArenaVec<table::Entry> ret(rows.size());
+        for(size_t i = 0; i < rows.size(); i++)
+            ret[i] = column[rows[i]];
+
+        return ret;
+    }
+
+    using ColumnRefs = std::vector<const util::ArenaVec<table::Entry>*>;
+
+    static size_t hash_row(const ColumnRefs& columns, size_t row)
     {
-        START_BENCHMARK_TIMER(zpr::sprint("****** Time spent merging tables of {} x {}", m_rows.size(), other.size()));
+        size_t seed = 0;
+        for(auto* col : columns)
+            util::_hash_combine(seed, (*col)[row]);
 
-        // use copy assignment to create new rows
-        util::ArenaVec<IntRow> new_rows;
-        new_rows.reserve(m_rows.size() * other.getRows().size());
+        return seed;
+    }
+
+    static bool rows_equal(const ColumnRefs& a_columns, size_t a, const ColumnRefs& b_columns, size_t b)
+    {
+        for(size_t i = 0; i < a_columns.size(); i++)
+        {
+            if((*a_columns[i])[a] != (*b_columns[i])[b])
+                return false;
+        }
+        return true;
+    }
+
+    void IntTable::keepRows(const std::vector<size_t>& rows)
+    {
+        for(auto& col : m_columns)
+            col = gather(col, rows);
+
+        m_num_rows = rows.size();
+    }
+
+    void IntTable::joinRows(
+        const IntTable& other, const std::vector<size_t>& this_rows, const std::vector<size_t>& other_rows)
+    {
+        spa_assert(this_rows.size() == other_rows.size());
+        this->keepRows(this_rows);
+
+        for(size_t i = 0; i < other.m_decls.size(); i++)
+        {
+            auto decl = other.m_decls[i];
+            if(m_headers.count(decl) > 0)
+                continue;
+
+            m_decls.push_back(decl);
+            m_headers.insert(decl);
+            m_columns.push_back(gather(other.m_columns[i], other_rows));
+        }
+    }
+
+    void IntTable::merge(const IntTable& other)
+    {
+        START_BENCHMARK_TIMER(zpr::sprint("****** Time spent merging tables of {} x {}", m_num_rows, other.size()));
 
         // m_rows should never be empty. Empty IntTable should contain an empty IntRow with no columns
-        if(m_rows.empty())
+        if(m_num_rows == 0)
         {
             util::logfmt("pql::eval::solver", "Detected IntTbl in {}. IntTbl will always be invalid", toString());
         }
 
-        for(const auto& this_row : m_rows)
+        ColumnRefs this_keys {};
+        ColumnRefs other_keys {};
+        for(size_t i = 0; i < other.m_decls.size(); i++)
+        {
+            if(m_headers.count(other.m_decls[i]) == 0)
+                continue;
+
+            this_keys.push_back(&m_columns[this->getColumnIndex(other.m_decls[i])]);
+            other_keys.push_back(&other.m_columns[i]);
+        }
+
+        std::vector<size_t> this_rows {};
+        std::vector<size_t> other_rows {};
+
+        if(this_keys.empty())
         {
-            for(const auto& other_row : other.getRows())
+            this_rows.reserve(m_num_rows * other.m_num_rows);
+            other_rows.reserve(m_num_rows * other.m_num_rows);
+            for(size_t i = 0; i < m_num_rows; i++)
             {
-                if(this_row.canMerge(other_row, other.getHeaders()))
+                for(size_t j = 0; j < other.m_num_rows; j++)
                 {
-                    IntRow new_row(this_row);
-                    new_row.mergeRow(other_row, other.getHeaders());
-
-                    new_rows.emplace_back(std::move(new_row));
+                    this_rows.push_back(i);
+                    other_rows.push_back(j);
                 }
             }
         }
+        else
+        {
+            // hash join: build on the smaller side, then probe with each row of the bigger side. the buckets
+            // are keyed by hash, so each match still needs to be checked.
+            bool build_this = m_num_rows <= other.m_num_rows;
+            auto& build_keys = build_this ? this_keys : other_keys;
+            auto& probe_keys = build_this ? other_keys : this_keys;
+            auto num_build = build_this ? m_num_rows : other.m_num_rows;
+            auto num_probe = build_this ? other.m_num_rows : m_num_rows;
+
+            std::unordered_map<size_t, std::vector<size_t>> buckets {};
+            buckets.reserve(num_build);
+            for(size_t i = 0; i < num_build; i++)
+                buckets[hash_row(build_keys, i)].push_back(i);
+
+            auto& build_rows = build_this ? this_rows : other_rows;
+            auto& probe_rows = build_this ? other_rows : this_rows;
+            for(size_t j = 0; j < num_probe; j++)
+            {
+                auto it = buckets.find(hash_row(probe_keys, j));
+                if(it == buckets.end())
+                    continue;
+
+                for(auto i : it->second)
+                {
+                    if(!rows_equal(build_keys, i, probe_keys, j))
+                        continue;
 
-        m_rows = std::move(new_rows);
+                    build_rows.push_back(i);
+                    probe_rows.push_back(j);
+                }
+            }
+        }
 
-        for(const ast::Declaration* header : other.getHeaders())
-            m_headers.insert(header);
+        this->joinRows(other, this_rows, other_rows);
     }
 
     void IntTable::mergeColumn(const ast::Declaration* decl, const table::Domain& domain)
@@ -210,45 +344,110 @@ namespace pql::eval::solver
             throw util::PqlException("pql::eval::solver",
                 "Failed to mergeColumn decl:{} with {}. Decl already in headers", decl->toString(), toString());
         }
-        // use copy assignment to create new rows
-        util::ArenaVec<IntRow> new_rows;
-        if(m_rows.empty())
+        if(m_num_rows == 0)
         {
             util::logfmt("pql::eval::solver", "Merging {} to emtpy tbl {} will always result in empty table",
                 decl->toString(), toString());
         }
-        for(const auto& row : m_rows)
+        for(const auto& entry : domain)
+        {
+            if(entry.getDeclaration() != decl)
+                throw util::PqlException("pql::eval::solver",
+                    "Failed to merge column to {} due to conflicting decl:{} and provided entry: {}", toString(),
+                    decl->toString(), entry.getDeclaration()->toString());
+        }
+
+        std::vector<size_t> rows {};
+        util::ArenaVec<table::Entry> column {};
+        rows.reserve(m_num_rows * domain.size());
+        column.reserve(m_num_rows * domain.size());
+        for(size_t i = 0; i < m_num_rows; i++)
         {
             for(const auto& entry : domain)
             {
-                if(entry.getDeclaration() != decl)
-                    throw util::PqlException("pql::eval::solver",
-                        "Failed to merge column to {} due to conflicting decl:{} and provided entry: {}", toString(),
-                        decl->toString(), entry.getDeclaration()->toString());
-                IntRow new_row(row);
-                new_row.addColumn(decl, entry);
-                util::logfmt("pql::eval::solver", "New row:{} from merging {} with {}", new_row.toString(),
-                    row.toString(), entry.toString());
-
-                new_rows.emplace_back(std::move(new_row));
+                rows.push_back(i);
+                column.push_back(entry);
             }
         }
+
+        this->keepRows(rows);
+        m_decls.push_back(decl);
         m_headers.insert(decl);
-        m_rows = std::move(new_rows);
+        m_columns.push_back(std::move(column));
     }
 
     void IntTable::dedupRows()
     {
-        START_BENCHMARK_TIMER(zpr::sprint("row deduplication (have {} rows)", m_rows.size()));
+        START_BENCHMARK_TIMER(zpr::sprint("row deduplication (have {} rows)", m_num_rows));
+        if(m_num_rows < 2)
+            return;
 
-        // no copies required; move rows into the set (deduplicating them in the process)
-        std::unordered_set<IntRow> seen {};
-        for(auto& row : m_rows)
-            seen.emplace(std::move(row));
+        // the entries of a column only differ in their 32-bit value, so radix sort the rows by the value
+        // of every column, a byte at a time (least significant first). duplicates then end up next to each other.
+        // this runs after every projection, so the scratch space comes from the arena and not the heap.
+        spa_assert(m_num_rows <= std::numeric_limits<uint32_t>::max());
+        util::ArenaVec<uint32_t> order(m_num_rows);
+        util::ArenaVec<uint32_t> sorted(m_num_rows);
+        for(size_t i = 0; i < m_num_rows; i++)
+            order[i] = static_cast<uint32_t>(i);
 
-        // then move them back into our list.
-        m_rows.assign(std::move_iterator(seen.begin()), std::move_iterator(seen.end()));
+        for(size_t c = m_columns.size(); c-- > 0;)
+        {
+            const auto& column = m_columns[c];
+            spa_assert(std::all_of(column.begin(), column.end(),
+                [&](const auto& e) -> bool { return (e.getKey() >> 32) == (column[0].getKey() >> 32); }));
 
+            for(size_t shift = 0; shift < 32; shift += 8)
+            {
+                auto digit = [&](size_t row) -> size_t { return (column[row].getKey() >> shift) & 0xFF; };
+
+                std::array<size_t, 257> starts {};
+                for(auto row : order)
+                    starts[digit(row) + 1]++;
+
+                // every row has the same digit, so this pass would not move anything
+                if(std::find(starts.begin(), starts.end(), m_num_rows) != starts.end())
+                    continue;
+
+                for(size_t d = 1; d < starts.size(); d++)
+                    starts[d] += starts[d - 1];
+
+                for(auto row : order)
+                    sorted[starts[digit(row)]++] = row;
+
+                order.swap(sorted);
+            }
+        }
+
+        auto rows_differ = [this](size_t a, size_t b) -> bool {
+            return std::any_of(m_columns.begin(), m_columns.end(),
+                [a, b](const auto& column) -> bool { return column[a] != column[b]; });
+        };
+
+        // keep the first row of every run of equal rows, then move the kept rows down in place,
+        // so they stay in their original order. the other buffer is free again, so it holds the flags.
+        auto& keep = sorted;
+        std::fill(keep.begin(), keep.end(), 0);
+        keep[order[0]] = 1;
+        for(size_t i = 1; i < m_num_rows; i++)
+        {
+            if(rows_differ(order[i - 1], order[i]))
+                keep[order[i]] = 1;
+        }
+
+        size_t num_kept = 0;
+        for(auto& column : m_columns)
+        {
+            num_kept = 0;
+            for(size_t i = 0; i < m_num_rows; i++)
+            {
+                if(keep[i])
+                    column[num_kept++] = column[i];
+            }
+            column.resize(num_kept);
+        }
+
+        m_num_rows = m_columns.empty() ? 1 : num_kept;
         util::logfmt("pql::eval::solver", "Rows after deduplicating {}", toString());
     }
 
@@ -257,24 +456,28 @@ namespace pql::eval::solver
         return this->m_headers;
     }
 
-    const util::ArenaVec<IntRow>& IntTable::getRows() const
+    util::ArenaVec<IntRow> IntTable::getRows() const
     {
-        return this->m_rows;
-    }
+        util::ArenaVec<IntRow> rows {};
+        rows.reserve(m_num_rows);
+        for(size_t i = 0; i < m_num_rows; i++)
+            rows.push_back(this->getRow(i));
 
-    const IntRow& IntTable::getRow(size_t i) const
-    {
-        return m_rows[i];
+        return rows;
     }
 
-    IntRow& IntTable::getRowMutable(size_t i)
+    IntRow IntTable::getRow(size_t i) const
     {
-        return m_rows[i];
+        util::ArenaVec<table::Entry> columns(m_columns.size());
+        for(size_t k = 0; k < m_columns.size(); k++)
+            columns[k] = m_columns[k][i];
+
+        return IntRow(std::move(columns));
     }
 
     size_t IntTable::size() const
     {
-        return m_rows.size();
+        return m_num_rows;
     }
 
     size_t IntTable::numColumns() const
@@ -284,7 +487,7 @@ namespace pql::eval::solver
 
     void IntTable::filterRows(const table::Join& join)
     {
-        START_BENCHMARK_TIMER(zpr::sprint("****** Time spent filtering {} rows", m_rows.size()));
+        START_BENCHMARK_TIMER(zpr::sprint("****** Time spent filtering {} rows", m_num_rows));
         const ast::Declaration* decl_a = join.getDeclA();
         const ast::Declaration* decl_b = join.getDeclB();
         if(!(m_headers.count(decl_a) && m_headers.count(decl_b)))
@@ -294,77 +497,134 @@ namespace pql::eval::solver
             return;
         }
 
-        util::ArenaVec<IntRow> new_rows {};
+        auto& col_a = this->getColumn(decl_a);
+        auto& col_b = this->getColumn(decl_b);
 
-        new_rows.reserve(m_rows.size());
-        std::copy_if(std::move_iterator(m_rows.begin()), std::move_iterator(m_rows.end()), std::back_inserter(new_rows),
-            [&](const auto& row) -> bool { return row.isAllowed(join); });
+        std::vector<size_t> allowed_rows {};
+        allowed_rows.reserve(m_num_rows);
+        for(size_t i = 0; i < m_num_rows; i++)
+        {
+            if(join.isAllowedEntry({ col_a[i], col_b[i] }))
+                allowed_rows.push_back(i);
+        }
 
         util::logfmt(
-            "pql::eval::solver", "Join(id: {}) filter tbl from {} to {}", join.getId(), m_rows.size(), new_rows.size());
+            "pql::eval::solver", "Join(id: {}) filter tbl from {} to {}", join.getId(), m_num_rows, allowed_rows.size());
 
-        m_rows = std::move(new_rows);
+        this->keepRows(allowed_rows);
     }
+
     void IntTable::filterColumns(const TableHeaders& allowed_columns)
     {
-        for(auto& row : m_rows)
+        size_t k = 0;
+        for(size_t i = 0; i < m_decls.size(); i++)
         {
-            row.filterColumns(allowed_columns);
-        }
-
-        auto it = m_headers.begin();
-        while(it != m_headers.end())
-        {
-            if(allowed_columns.count(*it) == 0)
+            if(allowed_columns.count(m_decls[i]) == 0)
             {
-                it = m_headers.erase(it);
+                m_headers.erase(m_decls[i]);
+                continue;
             }
-            else
+
+            if(k != i)
             {
-                it++;
+                m_decls[k] = m_decls[i];
+                m_columns[k] = std::move(m_columns[i]);
             }
+            k++;
         }
+
+        m_decls.resize(k);
+        m_columns.resize(k);
     }
 
     void IntTable::mergeAndFilter(const IntTable& other, const table::Join& join)
     {
         START_BENCHMARK_TIMER(
-            zpr::sprint("****** Time spent merging+filtering tables of {} x {}", m_rows.size(), other.size()));
+            zpr::sprint("****** Time spent merging+filtering tables of {} x {}", m_num_rows, other.size()));
 
-        util::ArenaVec<IntRow> new_rows;
-        new_rows.reserve(m_rows.size() * other.getRows().size());
-
-        if(m_rows.empty())
+        if(m_num_rows == 0)
             util::logfmt("pql::eval::solver", "Detected IntTbl in {}. IntTbl will always be invalid", toString());
 
-        for(const auto& this_row : m_rows)
+        const ast::Declaration* decl_a = join.getDeclA();
+        const ast::Declaration* decl_b = join.getDeclB();
+
+        bool shares_columns = std::any_of(other.m_decls.begin(), other.m_decls.end(),
+            [this](auto* decl) -> bool { return m_headers.count(decl) > 0; });
+
+        // the join can only be used as the key if it goes from one of our columns to one of theirs; otherwise
+        // (or if the tables share columns), do a normal merge and filter afterwards.
+        const ast::Declaration* this_decl = nullptr;
+        const ast::Declaration* other_decl = nullptr;
+        if(m_headers.count(decl_a) && other.m_headers.count(decl_b))
+            this_decl = decl_a, other_decl = decl_b;
+        else if(m_headers.count(decl_b) && other.m_headers.count(decl_a))
+            this_decl = decl_b, other_decl = decl_a;
+
+        if(shares_columns || this_decl == nullptr)
         {
-            for(const auto& other_row : other.getRows())
-            {
-                if(this_row.canMerge(other_row, other.getHeaders()))
-                {
-                    IntRow new_row(this_row);
-                    new_row.mergeRow(other_row, other.getHeaders());
+            this->merge(other);
+            this->filterRows(join);
+            return;
+        }
 
-                    if(new_row.isAllowed(join))
-                        new_rows.emplace_back(std::move(new_row));
-                }
+        // a lazy join is only asked about the values that are actually in our column
+        std::unordered_map<table::Entry, std::vector<table::Entry>> partners {};
+        if(join.isLazy())
+        {
+            for(const auto& entry : this->getColumn(this_decl))
+            {
+                if(partners.count(entry) == 0)
+                    partners.emplace(entry, join.getPartners(entry));
+            }
+        }
+        else
+        {
+            for(const auto& [a, b] : join.getAllowedEntries())
+            {
+                if(this_decl == decl_a)
+                    partners[a].push_back(b);
+                else
+                    partners[b].push_back(a);
             }
         }
 
-        m_rows = std::move(new_rows);
+        auto& other_col = other.getColumn(other_decl);
+        std::unordered_map<table::Entry, std::vector<size_t>> other_index {};
+        for(size_t j = 0; j < other.m_num_rows; j++)
+            other_index[other_col[j]].push_back(j);
 
-        for(const ast::Declaration* header : other.getHeaders())
-            m_headers.insert(header);
-    }
+        std::vector<size_t> this_rows {};
+        std::vector<size_t> other_rows {};
+
+        auto& this_col = this->getColumn(this_decl);
+        for(size_t i = 0; i < m_num_rows; i++)
+        {
+            auto it = partners.find(this_col[i]);
+            if(it == partners.end())
+                continue;
 
+            for(const auto& partner : it->second)
+            {
+                auto jt = other_index.find(partner);
+                if(jt == other_index.end())
+                    continue;
 
+                for(auto j : jt->second)
+                {
+                    this_rows.push_back(i);
+                    other_rows.push_back(j);
+                }
+            }
+        }
+
+        this->joinRows(other, this_rows, other_rows);
+    }
 
     bool IntTable::empty() const
     {
-        return m_rows.empty() ||
+        return m_num_rows == 0 ||
                // contains an empty row
-               (m_rows.size() == 1 && m_rows.front().getColumns().empty());
+               (m_num_rows == 1 && m_columns.empty());
     }
 
     std::string IntTable::toString() const
@@ -376,19 +636,18 @@ namespace pql::eval::solver
             ret += zpr::sprint("{}, ", header->toString());
         }
         ret += "]\nm_rows:[";
-        for(const auto& row : m_rows)
+        for(size_t i = 0; i < m_num_rows; i++)
         {
-            ret += zpr::sprint("{}, ", row.toString());
+            ret += zpr::sprint("{}, ", this->getRow(i).toString());
         }
         ret += "])";
         return ret;
     }
 
-    DepGraph::DepGraph(const TableHeaders& decls, std::vector<table::Join> joins)
-        : m_joins(std::move(joins)), m_colouring(), m_graph()
+    DepGraph::DepGraph(const TableHeaders& decls, const std::vector<table::Join>& joins) : m_colouring(), m_graph()
     {
         util::logfmt("pql::eval::solver", "Constructing Dependency Graph");
-        for(const auto& join : m_joins)
+        for(const auto& join : joins)
         {
             util::logfmt("pql::eval::solver::dep_g", "Adding {} to {}", join.getDeclA()->toString(),
                 join.getDeclB()->toString());
@@ -453,6 +712,21 @@ namespace pql::eval::solver
         return ret;
     }
 
+    bool DepGraph::isCyclic(const std::vector<const ast::Declaration*>& component) const
+    {
+        // a connected graph has a cycle iff it has at least as many edges as nodes.
+        size_t num_edges = 0;
+        for(const ast::Declaration* decl : component)
+        {
+            auto it = m_graph.find(decl);
+            if(it != m_graph.end())
+                num_edges += it->second.size() - it->second.count(decl);
+        }
+
+        // every edge was counted from both ends
+        return num_edges / 2 >= component.size();
+    }
+
     static TableHeaders mergeAndCopySet(TableHeaders a, const TableHeaders& b)
     {
         TableHeaders ret(std::move(a));
@@ -473,8 +747,8 @@ namespace pql::eval::solver
             for(const auto decl : component)
             {
                 // All decl should belong to a table
-                spa_assert(has_table(decl));
-                size_t table_i = get_table_index(decl);
+                spa_assert(hasTable(decl));
+                size_t table_i = getTableIndex(decl);
                 size_decls.emplace_back(m_int_tables[table_i].size(), decl);
             }
             // sort smallest IntTable first
@@ -491,15 +765,46 @@ namespace pql::eval::solver
         }
         return ret;
     };
-    Solver::Solver(const std::vector<table::Join>& joins,
-        std::unordered_map<const ast::Declaration*, table::Domain> domains, const TableHeaders& return_decls,
-        const TableHeaders& select_decls)
-        : m_domains(std::move(domains)), m_joins(joins), m_return_decls(return_decls), m_int_tables(),
-          m_decl_components(), m_dep_graph(mergeAndCopySet(return_decls, select_decls), joins)
+    Solver::Solver(std::vector<table::Join> joins, std::unordered_map<const ast::Declaration*, table::Domain> domains,
+        const TableHeaders& return_decls, const TableHeaders& select_decls)
+        : m_domains(std::move(domains)), m_joins(std::move(joins)), m_return_decls(return_decls), m_int_tables(),
+          m_decl_components(), m_plans(), m_dep_graph(mergeAndCopySet(return_decls, select_decls), m_joins)
     {
         START_BENCHMARK_TIMER("Solver constructor");
-        trim(return_decls);
-        trim(select_decls);
+        size_t num_decl_indices = 0;
+        auto count_decl = [&num_decl_indices](const ast::Declaration* decl) {
+            num_decl_indices = std::max(num_decl_indices, static_cast<size_t>(table::getDeclarationIndex(decl)) + 1);
+        };
+        for(auto decl : return_decls)
+            count_decl(decl);
+        for(auto decl : select_decls)
+            count_decl(decl);
+        for(const auto& join : m_joins)
+        {
+            count_decl(join.getDeclA());
+            count_decl(join.getDeclB());
+        }
+
+        m_decl_parents.resize(num_decl_indices);
+        m_decl_set_sizes.resize(num_decl_indices, 1);
+        m_set_tables.resize(num_decl_indices, NO_TABLE);
+        m_decl_joins.resize(num_decl_indices);
+        for(size_t i = 0; i < num_decl_indices; i++)
+            m_decl_parents[i] = i;
+
+        for(size_t i = 0; i < m_joins.size(); i++)
+        {
+            auto a = table::getDeclarationIndex(m_joins[i].getDeclA());
+            auto b = table::getDeclarationIndex(m_joins[i].getDeclB());
+            m_decl_joins[a].push_back(i);
+            if(a != b)
+                m_decl_joins[b].push_back(i);
+        }
+
+        materialise_small_joins();
+        reduce();
+        // reducing the domains might have made some lazy joins small enough to store
+        materialise_small_joins();
         // all declaration should start as table initially
         for(const ast::Declaration* decl : return_decls)
         {
@@ -508,6 +813,7 @@ namespace pql::eval::solver
                 throw util::PqlException("pql::eval::solver", "{} does not have any domain", decl->toString());
 
             tbl.mergeColumn(decl, m_domains.find(decl)->second);
+            m_set_tables[find_decl_set(table::getDeclarationIndex(decl))] = m_int_tables.size();
             m_int_tables.push_back(std::move(tbl));
 
             util::logfmt("pql::eval::solver", "Adding {} to m_int_tables", tbl.toString());
@@ -519,12 +825,13 @@ namespace pql::eval::solver
             if(m_domains.count(decl) == 0)
                 throw util::PqlException("pql::eval::solver", "{} does not have any domain", decl->toString());
 
-            if(has_table(decl))
+            if(hasTable(decl))
             {
                 // IntTbl already initialized as decl is also a ret decl.
                 continue;
             }
             tbl.mergeColumn(decl, m_domains.find(decl)->second);
+            m_set_tables[find_decl_set(table::getDeclarationIndex(decl))] = m_int_tables.size();
             m_int_tables.push_back(std::move(tbl));
 
             util::logfmt("pql::eval::solver", "Adding {} to m_int_tables", tbl.toString());
@@ -534,118 +841,563 @@ namespace pql::eval::solver
         preprocess_int_table();
     }
 
-    std::vector<table::Join> Solver::get_joins(const ast::Declaration* decl) const
+    void Solver::materialise_small_joins()
     {
-        std::vector<table::Join> ret;
-        for(const table::Join& join : m_joins)
+        for(auto& join : m_joins)
         {
-            if(join.getDeclA() == decl || join.getDeclB() == decl)
-                ret.push_back(join);
+            if(join.isLazy() && join.size() <= MAX_MATERIALISED_PAIRS)
+                join.materialise(m_domains[join.getDeclA()], m_domains[join.getDeclB()]);
         }
-        return ret;
     }
 
-    void Solver::trim_helper(const ast::Declaration* decl, table::Join& join)
+    std::vector<const ast::Declaration*> Solver::reduce_join(table::Join& join)
     {
-        util::logfmt("pql::eval::solver", "Trimming {} and {}", decl->toString(), join.toString());
-        if(m_domains.count(decl) == 0)
-            throw util::PqlException("pql::solver::eval",
-                "Failed to trim {} with {}. Declaration's domain not initialised", decl->toString(), join.toString());
+        auto decl_a = join.getDeclA();
+        auto decl_b = join.getDeclB();
+        if(m_domains.count(decl_a) == 0 || m_domains.count(decl_b) == 0)
+            throw util::PqlException(
+                "pql::eval::solver", "Failed to reduce {}. Declaration's domain not initialised", join.toString());
+
+        if(join.isLazy())
+            return this->reduce_lazy_join(join);
 
-        const std::unordered_set<table::Entry>& domain = m_domains.find(decl)->second;
-        auto& join_allowed_entries = join.getAllowedEntries();
-        // Extract out decls' Entry from join
+        auto& domain_a = m_domains.find(decl_a)->second;
+        auto& domain_b = m_domains.find(decl_b)->second;
 
-        std::unordered_set<table::Entry> decl_join_allowed_entries;
-        for(const auto& [entry_a, entry_b] : join_allowed_entries)
+        // remove allowed entries that are no longer in the domains. if both sides are the same
+        // declaration, a row can only ever hold one value for it.
+        table::Domain support_a {};
+        table::Domain support_b {};
+        auto& allowed_entries = join.editAllowedEntries();
+        for(auto it = allowed_entries.begin(); it != allowed_entries.end();)
         {
-            if(entry_a.getDeclaration() == decl)
+            const auto& [entry_a, entry_b] = *it;
+            if(domain_a.count(entry_a) == 0 || domain_b.count(entry_b) == 0 || (decl_a == decl_b && entry_a != entry_b))
             {
-                decl_join_allowed_entries.insert(entry_a);
+                util::logfmt("pql::eval::solver", "Removing ({}, {}) from {}.", entry_a.toString(),
+                    entry_b.toString(), join.toString());
+                it = allowed_entries.erase(it);
             }
-            else if(entry_b.getDeclaration() == decl)
+            else
             {
-                decl_join_allowed_entries.insert(entry_b);
+                support_a.insert(entry_a);
+                support_b.insert(entry_b);
+                it++;
             }
-            else
+        }
+
+        // then remove domain entries that have no partner left in the join
+        std::vector<const ast::Declaration*> changed {};
+        auto keep_supported = [&](const ast::Declaration* decl, table::Domain& domain, const table::Domain& support) {
+            if(domain.size() == support.size())
+                return;
+
+            for(auto it = domain.begin(); it != domain.end();)
             {
-                throw util::PqlException("pql::eval::solver",
-                    "Failed to trim {} with {}. Join does not involve the declaration.", decl->toString(),
-                    join.toString());
+                if(support.count(*it) == 0)
+                    it = domain.erase(it);
+                else
+                    it++;
             }
+            changed.push_back(decl);
+        };
+
+        keep_supported(decl_a, domain_a, support_a);
+        if(decl_b != decl_a)
+            keep_supported(decl_b, domain_b, support_b);
+
+        return changed;
+    }
+
+    std::vector<const ast::Declaration*> Solver::reduce_lazy_join(table::Join& join)
+    {
+        auto decl_a = join.getDeclA();
+        auto decl_b = join.getDeclB();
+        auto& domain_a = m_domains.find(decl_a)->second;
+        auto& domain_b = m_domains.find(decl_b)->second;
+
+        std::vector<const ast::Declaration*> changed {};
+        if(decl_a == decl_b)
+        {
+            size_t num_pairs = 0;
+            size_t old_size = domain_a.size();
+            for(auto it = domain_a.begin(); it != domain_a.end();)
+            {
+                if(join.isAllowedEntry({ *it, *it }))
+                {
+                    num_pairs++;
+                    it++;
+                }
+                else
+                {
+                    it = domain_a.erase(it);
+                }
+            }
+
+            join.setLazySize(num_pairs);
+            if(domain_a.size() != old_size)
+                changed.push_back(decl_a);
+
+            return changed;
         }
-        // find the entries that are in both domain and joins
-        std::unordered_set<table::Entry> entry_set_intersect;
-        for(const auto& entry : domain)
+
+        // there are no pairs to remove, so walk them from the smaller side (getPartners goes either way),
+        // and count them while we're here.
+        bool walk_a = domain_a.size() <= domain_b.size();
+        auto& walked = walk_a ? domain_a : domain_b;
+        auto& other = walk_a ? domain_b : domain_a;
+
+        size_t num_pairs = 0;
+        table::Domain support {};
+        size_t old_size = walked.size();
+        for(auto it = walked.begin(); it != walked.end();)
         {
-            if(decl_join_allowed_entries.count(entry))
-                entry_set_intersect.insert(entry);
+            bool has_partner = false;
+            for(const auto& partner : join.getPartners(*it))
+            {
+                if(other.count(partner) > 0)
+                {
+                    support.insert(partner);
+                    has_partner = true;
+                    num_pairs++;
+                }
+            }
+
+            if(has_partner)
+                it++;
+            else
+                it = walked.erase(it);
         }
 
-        for(const auto& entry : decl_join_allowed_entries)
+        join.setLazySize(num_pairs);
+        if(walked.size() != old_size)
+            changed.push_back(walk_a ? decl_a : decl_b);
+
+        if(other.size() != support.size())
         {
-            if(domain.count(entry))
-                entry_set_intersect.insert(entry);
+            other = std::move(support);
+            changed.push_back(walk_a ? decl_b : decl_a);
         }
 
-        // Update domain with the new trimmed domain
-        m_domains[decl] = std::move(entry_set_intersect);
+        return changed;
+    }
+
+    void Solver::reduce()
+    {
+        START_BENCHMARK_TIMER("Semi-join reduction");
+        util::logfmt("pql::eval::solver", "Reducing declarations and joins");
 
-        // remove allowed entries to only contain trimmed entries
-        auto join_it = join_allowed_entries.begin();
-        while(join_it != join_allowed_entries.end())
+        // every join is looked at once; after that, a join only needs another look if one of its
+        // declarations lost an entry because of some other join.
+        std::queue<size_t> worklist {};
+        std::vector<bool> queued(m_joins.size(), true);
+        for(size_t i = 0; i < m_joins.size(); i++)
+            worklist.push(i);
+
+        while(!worklist.empty())
         {
-            const table::Entry& entry = join_it->first.getDeclaration() == decl ? join_it->first : join_it->second;
-            // remove allowed entries that are not in intersect
-            if(m_domains[decl].count(entry) == 0)
+            auto i = worklist.front();
+            worklist.pop();
+            queued[i] = false;
+
+            for(auto decl : reduce_join(m_joins[i]))
             {
-                util::logfmt("pql::eval::solver", "Removing {} from {}.", entry.toString(), join.toString());
-                join_it = join_allowed_entries.erase(join_it);
+                // there is no answer at all, so don't bother with the rest
+                if(m_domains[decl].empty())
+                {
+                    util::logfmt("pql::eval::solver", "Domain of {} is empty after reduction", decl->toString());
+                    return;
+                }
+
+                for(auto k : m_decl_joins[table::getDeclarationIndex(decl)])
+                {
+                    if(k != i && !queued[k])
+                    {
+                        queued[k] = true;
+                        worklist.push(k);
+                    }
+                }
             }
-            else
+        }
+    }
+
+    size_t Solver::find_decl_set(size_t decl_index) const
+    {
+        // union by size keeps the trees shallow enough that we don't need path compression
+        while(m_decl_parents[decl_index] != decl_index)
+            decl_index = m_decl_parents[decl_index];
+
+        return decl_index;
+    }
+
+    void Solver::union_decl_sets(size_t a, size_t b)
+    {
+        a = find_decl_set(a);
+        b = find_decl_set(b);
+        if(a == b)
+            return;
+
+        if(m_decl_set_sizes[a] < m_decl_set_sizes[b])
+            std::swap(a, b);
+
+        m_decl_parents[b] = a;
+        m_decl_set_sizes[a] += m_decl_set_sizes[b];
+        if(m_set_tables[a] == NO_TABLE)
+            m_set_tables[a] = m_set_tables[b];
+    }
+
+    std::vector<size_t> Solver::getComponentJoins(const std::vector<const ast::Declaration*>& component) const
+    {
+        // a join is in the component if its first declaration is, so each join is only counted once
+        std::vector<size_t> ret {};
+        for(auto decl : component)
+        {
+            auto idx = table::getDeclarationIndex(decl);
+            if(idx >= m_decl_joins.size())
+                continue;
+
+            for(auto i : m_decl_joins[idx])
             {
-                join_it++;
+                if(m_joins[i].getDeclA() == decl)
+                    ret.push_back(i);
             }
         }
+
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    bool Solver::hasTable(const ast::Declaration* decl) const
+    {
+        auto idx = table::getDeclarationIndex(decl);
+        return idx < m_decl_parents.size() && m_set_tables[find_decl_set(idx)] != NO_TABLE;
     }
 
-    void Solver::trim(const TableHeaders& decls)
+    size_t Solver::getTableIndex(const ast::Declaration* decl) const
     {
-        START_BENCHMARK_TIMER("Trimming declarations and joins");
-        util::logfmt("pql::eval::solver", "Trimming declarations");
-        for(table::Join& join : m_joins)
+        if(!hasTable(decl))
+            throw util::PqlException("pql::eval::solver", "{} belongs none of the IntTable", decl->toString());
+
+        return m_set_tables[find_decl_set(table::getDeclarationIndex(decl))];
+    }
+
+    std::string PlanStep::toString() const
+    {
+        switch(this->kind)
         {
-            if(decls.count(join.getDeclA()))
-                trim_helper(join.getDeclA(), join);
-            if(decls.count(join.getDeclB()))
-                trim_helper(join.getDeclB(), join);
+            case Kind::kScan:
+                return zpr::sprint("scan {} (~{} rows)", this->decl->toString(), this->estimated_rows);
+            case Kind::kMerge:
+                return zpr::sprint("merge {} via join {} (~{} rows)", this->decl->toString(), this->join->getId(),
+                    this->estimated_rows);
+            case Kind::kFilter:
+                return zpr::sprint("filter join {} (~{} rows)", this->join->getId(), this->estimated_rows);
+            case Kind::kBind:
+                return zpr::sprint("bind {} (~{} rows)", this->decl->toString(), this->estimated_rows);
         }
+        unreachable();
     }
 
-    bool Solver::has_table(const ast::Declaration* decl) const
+    JoinPlan Solver::plan_component(const std::vector<const ast::Declaration*>& component) const
     {
-        for(const auto& tbl : m_int_tables)
+        // before preprocessing, every declaration has its own single-column table, holding its (reduced) domain.
+        auto domain_size = [this](const ast::Declaration* decl) -> double {
+            return std::max(static_cast<double>(m_int_tables[getTableIndex(decl)].size()), 1.0);
+        };
+
+        TableHeaders in_table {};
+        std::vector<const table::Join*> pending {};
+        for(auto i : getComponentJoins(component))
+            pending.push_back(&m_joins[i]);
+
+        JoinPlan plan {};
+        auto start = *std::min_element(component.begin(), component.end(),
+            [&](auto a, auto b) -> bool { return domain_size(a) < domain_size(b); });
+
+        double estimate = m_int_tables[getTableIndex(start)].size();
+        plan.push_back(PlanStep { PlanStep::Kind::kScan, start, nullptr, estimate });
+        in_table.insert(start);
+
+        while(!pending.empty())
         {
-            if(tbl.getHeaders().count(decl))
-                return true;
+            // the fan-out of a join is how many partners each value on one side has on average; the
+            // selectivity of a filter is the fraction of all possible pairs that the join allows.
+            size_t best = pending.size();
+            PlanStep best_step {};
+            for(size_t i = 0; i < pending.size(); i++)
+            {
+                auto join = pending[i];
+                auto decl_a = join->getDeclA();
+                auto decl_b = join->getDeclB();
+                bool has_a = in_table.count(decl_a) > 0;
+                bool has_b = in_table.count(decl_b) > 0;
+                auto num_allowed = static_cast<double>(join->size());
+
+                PlanStep step {};
+                if(has_a && has_b)
+                {
+                    auto possible = decl_a == decl_b ? domain_size(decl_a) : domain_size(decl_a) * domain_size(decl_b);
+                    step = PlanStep { PlanStep::Kind::kFilter, decl_a, join, estimate * num_allowed / possible };
+                }
+                else if(has_a || has_b)
+                {
+                    auto present = has_a ? decl_a : decl_b;
+                    auto missing = has_a ? decl_b : decl_a;
+                    step = PlanStep { PlanStep::Kind::kMerge, missing, join,
+                        estimate * num_allowed / domain_size(present) };
+                }
+                else
+                {
+                    continue;
+                }
+
+                // on ties, prefer filters since they never grow the table
+                if(best == pending.size() || step.estimated_rows < best_step.estimated_rows ||
+                    (step.estimated_rows == best_step.estimated_rows && step.kind == PlanStep::Kind::kFilter &&
+                        best_step.kind != PlanStep::Kind::kFilter))
+                {
+                    best = i;
+                    best_step = step;
+                }
+            }
+
+            // the component is connected, so there is always a join touching the table
+            spa_assert(best < pending.size());
+
+            estimate = best_step.estimated_rows;
+            in_table.insert(best_step.decl);
+            plan.push_back(best_step);
+            pending.erase(pending.begin() + best);
         }
-        return false;
+
+        return plan;
     }
 
-    size_t Solver::get_table_index(const ast::Declaration* decl) const
+    JoinPlan Solver::plan_generic_join(const std::vector<const ast::Declaration*>& component) const
     {
-        std::vector<size_t> ret;
-        for(size_t i = 0; i < m_int_tables.size(); i++)
+        auto domain_size = [this](const ast::Declaration* decl) -> double {
+            return std::max(static_cast<double>(m_int_tables[getTableIndex(decl)].size()), 1.0);
+        };
+
+        std::vector<const table::Join*> joins {};
+        for(auto i : getComponentJoins(component))
         {
-            if(m_int_tables[i].getHeaders().count(decl))
-                ret.emplace_back(i);
+            if(m_joins[i].getDeclA() != m_joins[i].getDeclB())
+                joins.push_back(&m_joins[i]);
         }
-        if(ret.size() > 1)
-            throw util::PqlException(
-                "pql::eval::solver", "{} belongs to more than one IntTable. IntTbl: {}", decl->toString(), toString());
-        if(ret.empty())
-            throw util::PqlException("pql::eval::solver", "{} belongs none of the IntTable", decl->toString());
-        return ret.front();
+
+        JoinPlan plan {};
+        TableHeaders bound {};
+        double estimate = 1;
+        while(plan.size() < component.size())
+        {
+            // the number of candidates for a declaration is at most the fan-out of its most selective join
+            // to a bound declaration; the first one has nothing bound, so it is just its domain.
+            const ast::Declaration* best = nullptr;
+            size_t best_joins = 0;
+            double best_estimate = 0;
+            for(const ast::Declaration* decl : component)
+            {
+                if(bound.count(decl) > 0)
+                    continue;
+
+                size_t num_joins = 0;
+                double fan_out = domain_size(decl);
+                for(const table::Join* join : joins)
+                {
+                    auto other = join->getDeclA() == decl ? join->getDeclB()
+                               : join->getDeclB() == decl ? join->getDeclA()
+                                                          : nullptr;
+                    if(other == nullptr || bound.count(other) == 0)
+                        continue;
+
+                    num_joins++;
+                    fan_out = std::min(fan_out, join->size() / domain_size(other));
+                }
+
+                if(!bound.empty() && num_joins == 0)
+                    continue;
+
+                if(best == nullptr || num_joins > best_joins ||
+                    (num_joins == best_joins && estimate * fan_out < best_estimate))
+                {
+                    best = decl;
+                    best_joins = num_joins;
+                    best_estimate = estimate * fan_out;
+                }
+            }
+
+            // the component is connected, so there is always a declaration joined to the bound ones
+            spa_assert(best != nullptr);
+
+            estimate = best_estimate;
+            bound.insert(best);
+            plan.push_back(PlanStep { PlanStep::Kind::kBind, best, nullptr, estimate });
+        }
+
+        return plan;
+    }
+
+    static bool entry_less(const table::Entry& a, const table::Entry& b)
+    {
+        return a.getKey() < b.getKey();
+    }
+
+    namespace
+    {
+        // the candidates of a declaration given the value of one that is bound before it, from one join
+        struct BindConstraint
+        {
+            size_t bound_step;
+            std::unordered_map<table::Entry, std::vector<table::Entry>> partners;
+
+            // for lazy joins, the partners of a value are only looked up when it is first bound
+            const table::Join* lazy_join = nullptr;
+            const table::Domain* domain = nullptr;
+        };
+
+        struct GenericJoinState
+        {
+            std::vector<table::Entry> first_candidates;
+            std::vector<std::vector<BindConstraint>> constraints;
+            std::vector<std::vector<const table::Join*>> self_joins;
+            std::vector<table::Entry> binding;
+            std::vector<util::ArenaVec<table::Entry>> columns;
+        };
+    }
+
+    static void generic_join_bind(GenericJoinState& state, size_t step)
+    {
+        if(step == state.binding.size())
+        {
+            for(size_t i = 0; i < state.binding.size(); i++)
+                state.columns[i].push_back(state.binding[i]);
+            return;
+        }
+
+        // every join to a bound declaration gives a sorted list of candidates; the ones that survive are
+        // in all of them. walk the shortest list, and leapfrog a cursor through each of the others.
+        std::vector<const std::vector<table::Entry>*> lists {};
+        if(step == 0)
+        {
+            lists.push_back(&state.first_candidates);
+        }
+        else
+        {
+            for(auto& constraint : state.constraints[step])
+            {
+                const auto& bound_value = state.binding[constraint.bound_step];
+                auto it = constraint.partners.find(bound_value);
+                if(it == constraint.partners.end() && constraint.lazy_join != nullptr)
+                {
+                    std::vector<table::Entry> partners {};
+                    for(const auto& partner : constraint.lazy_join->getPartners(bound_value))
+                    {
+                        if(constraint.domain->count(partner) > 0)
+                            partners.push_back(partner);
+                    }
+
+                    std::sort(partners.begin(), partners.end(), entry_less);
+                    it = constraint.partners.emplace(bound_value, std::move(partners)).first;
+                }
+
+                if(it == constraint.partners.end())
+                    return;
+                lists.push_back(&it->second);
+            }
+        }
+
+        // the plan only binds a declaration once something it is joined to is bound
+        spa_assert(!lists.empty());
+        std::sort(lists.begin(), lists.end(), [](auto a, auto b) -> bool { return a->size() < b->size(); });
+        std::vector<std::vector<table::Entry>::const_iterator> cursors {};
+        for(auto list : lists)
+            cursors.push_back(list->begin());
+
+        for(const auto& candidate : *lists[0])
+        {
+            bool in_all = true;
+            for(size_t i = 1; i < lists.size() && in_all; i++)
+            {
+                cursors[i] = std::lower_bound(cursors[i], lists[i]->end(), candidate, entry_less);
+                in_all = cursors[i] != lists[i]->end() && *cursors[i] == candidate;
+            }
+
+            if(!in_all)
+                continue;
+
+            if(std::all_of(state.self_joins[step].begin(), state.self_joins[step].end(),
+                   [&](auto join) -> bool { return join->isAllowedEntry({ candidate, candidate }); }))
+            {
+                state.binding[step] = candidate;
+                generic_join_bind(state, step + 1);
+            }
+        }
+    }
+
+    IntTable Solver::generic_join(const std::vector<const ast::Declaration*>& component, const JoinPlan& plan) const
+    {
+        std::unordered_map<const ast::Declaration*, size_t> steps {};
+        std::vector<const ast::Declaration*> decls {};
+        for(const PlanStep& step : plan)
+        {
+            spa_assert(step.kind == PlanStep::Kind::kBind);
+            steps[step.decl] = decls.size();
+            decls.push_back(step.decl);
+        }
+
+        auto in_domain = [this](const table::Entry& entry) -> bool {
+            return m_domains.find(entry.getDeclaration())->second.count(entry) > 0;
+        };
+
+        GenericJoinState state {};
+        state.constraints.resize(decls.size());
+        state.self_joins.resize(decls.size());
+        state.binding.resize(decls.size());
+        state.columns.resize(decls.size());
+
+        const auto& first_domain = m_domains.find(decls.front())->second;
+        state.first_candidates.assign(first_domain.begin(), first_domain.end());
+        std::sort(state.first_candidates.begin(), state.first_candidates.end(), entry_less);
+
+        for(auto i : getComponentJoins(component))
+        {
+            const auto& join = m_joins[i];
+            auto step_a = steps[join.getDeclA()];
+            auto step_b = steps[join.getDeclB()];
+            if(step_a == step_b)
+            {
+                state.self_joins[step_a].push_back(&join);
+                continue;
+            }
+
+            // index the join by whichever side is bound first
+            auto& constraint = state.constraints[std::max(step_a, step_b)].emplace_back();
+            constraint.bound_step = std::min(step_a, step_b);
+            if(join.isLazy())
+            {
+                constraint.lazy_join = &join;
+                constraint.domain = &m_domains.find(decls[std::max(step_a, step_b)])->second;
+                continue;
+            }
+
+            for(const auto& [entry_a, entry_b] : join.getAllowedEntries())
+            {
+                if(!in_domain(entry_a) || !in_domain(entry_b))
+                    continue;
+
+                if(step_a < step_b)
+                    constraint.partners[entry_a].push_back(entry_b);
+                else
+                    constraint.partners[entry_b].push_back(entry_a);
+            }
+
+            for(auto& [_, partners] : constraint.partners)
+                std::sort(partners.begin(), partners.end(), entry_less);
+        }
+
+        generic_join_bind(state, 0);
+        return IntTable(std::move(decls), std::move(state.columns));
     }
 
     // update m_int_tables with tables that corresponds to a comp
@@ -653,9 +1405,7 @@ namespace pql::eval::solver
     {
         START_BENCHMARK_TIMER("Preprocess initial table");
         util::logfmt("pql::eval::solver", "Starting pre-process");
-        TableHeaders processed_decl;
         std::vector<IntTable> new_int_tables;
-        std::unordered_set<int> processed_join;
 
         for(std::vector<const ast::Declaration*>& component : m_decl_components)
         {
@@ -669,54 +1419,96 @@ namespace pql::eval::solver
                 return log + "}";
             }());
 
-            std::sort(component.begin(), component.end(), [&](auto& a, auto& b) -> bool {
-                return m_int_tables[get_table_index(a)].size() < m_int_tables[get_table_index(b)].size();
-            });
+            bool cyclic = m_dep_graph.isCyclic(component);
+            JoinPlan plan = cyclic ? plan_generic_join(component) : plan_component(component);
+            util::logfmt("pql::eval::solver", "Plan for component: {}", [&]() -> std::string {
+                std::string log {};
+                for(const auto& step : plan)
+                    log += step.toString() + "; ";
+                return log;
+            }());
 
-            for(const ast::Declaration* decl : component)
+            if(cyclic)
+            {
+                START_BENCHMARK_TIMER("**** executing generic join");
+                new_table = generic_join(component, plan);
+                plan.back().actual_rows = new_table.size();
+                util::logfmt("pql::eval::solver", "generic join gave {} rows (estimated {})", new_table.size(),
+                    plan.back().estimated_rows);
+            }
+            else
             {
-                IntTable& prev_table = m_int_tables[get_table_index(decl)];
-                // merge to new table if it has not been processed
-                if(new_table.getHeaders().count(decl) == 0)
+                // the last step that needs each declaration. after that, one that is not returned only
+                // slows down the joins that follow, so its column is dropped as soon as it is done.
+                std::unordered_map<const ast::Declaration*, size_t> last_use {};
+                for(size_t i = 0; i < plan.size(); i++)
                 {
-                    util::logfmt("pql::eval::solver", "merging decl {} from {} into {}", decl->toString(),
-                        prev_table.toString(), new_table.toString());
-                    new_table.merge(prev_table);
+                    last_use[plan[i].decl] = i;
+                    if(plan[i].join != nullptr)
+                    {
+                        last_use[plan[i].join->getDeclA()] = i;
+                        last_use[plan[i].join->getDeclB()] = i;
+                    }
                 }
 
-                START_BENCHMARK_TIMER(zpr::sprint("**** filtered joins for {}", decl->name));
-                std::vector<table::Join> joins = get_joins(decl);
-
-                for(const table::Join& join : joins)
+                for(size_t i = 0; i < plan.size(); i++)
                 {
-                    if(processed_join.count(join.getId()))
+                    PlanStep& step = plan[i];
+                    START_BENCHMARK_TIMER(zpr::sprint("**** executing {}", step.toString()));
+                    switch(step.kind)
                     {
-                        util::logfmt("pql::eval::solver",
-                            "Skipping filter join with id {} as it has already been processed.", join.getId());
-                        continue;
+                        case PlanStep::Kind::kScan:
+                            new_table.merge(m_int_tables[getTableIndex(step.decl)]);
+                            break;
+
+                        case PlanStep::Kind::kMerge:
+                            new_table.mergeAndFilter(m_int_tables[getTableIndex(step.decl)], *step.join);
+                            break;
+
+                        case PlanStep::Kind::kFilter:
+                            new_table.filterRows(*step.join);
+                            break;
+
+                        case PlanStep::Kind::kBind:
+                            unreachable();
                     }
 
-                    const ast::Declaration* other_decl = join.getDeclA() == decl ? join.getDeclB() : join.getDeclA();
-                    if(new_table.getHeaders().count(other_decl) == 0)
-                    {
-                        IntTable& other_prev_table = m_int_tables[get_table_index(other_decl)];
-                        util::logfmt(
-                            "pql::eval::solver", "Merging {} to {}", other_prev_table.toString(), new_table.toString());
+                    util::logfmt("pql::eval::solver", "{} gave {} rows (estimated {})", step.toString(),
+                        new_table.size(), step.estimated_rows);
 
-                        new_table.mergeAndFilter(other_prev_table, join);
+                    // If a table is empty, there will never be a valid assignment and we can terminate early.
+                    // the rest of the plan never ran, so it isn't kept either.
+                    step.actual_rows = new_table.size();
+                    if(new_table.size() == 0)
+                    {
+                        plan.resize(i + 1);
+                        break;
                     }
-                    else
+
+                    // the columns are filtered after the last step anyway
+                    if(i + 1 == plan.size())
+                        continue;
+
+                    TableHeaders needed {};
+                    for(const ast::Declaration* decl : new_table.getHeaders())
                     {
-                        new_table.filterRows(join);
+                        if(m_return_decls.count(decl) > 0 || last_use[decl] > i)
+                            needed.insert(decl);
                     }
 
-                    processed_join.insert(join.getId());
-                    // If a table is empty, there will never be a valid assignment and we can terminate early
-                    if(new_table.size() == 0)
-                        break;
+                    if(needed.size() < new_table.numColumns())
+                    {
+                        new_table.filterColumns(needed);
+                        new_table.dedupRows();
+                        step.actual_rows = new_table.size();
+                        util::logfmt("pql::eval::solver", "{} rows left after projecting to {} columns",
+                            new_table.size(), new_table.numColumns());
+                    }
                 }
             }
 
+            m_plans.push_back(std::move(plan));
+
             util::logfmt("pql::eval::solver", "New final merged table for component {}", new_table.toString());
 
             /*
@@ -747,6 +1539,29 @@ namespace pql::eval::solver
         }
 
         m_int_tables = std::move(new_int_tables);
+
+        // the declarations are now grouped by component, and the ones that were projected away have no table
+        std::fill(m_set_tables.begin(), m_set_tables.end(), NO_TABLE);
+        std::fill(m_decl_set_sizes.begin(), m_decl_set_sizes.end(), 1);
+        for(size_t i = 0; i < m_decl_parents.size(); i++)
+            m_decl_parents[i] = i;
+
+        for(size_t i = 0; i < m_int_tables.size(); i++)
+        {
+            std::optional<size_t> first {};
+            for(const ast::Declaration* decl : m_int_tables[i].getHeaders())
+            {
+                auto idx = table::getDeclarationIndex(decl);
+                if(first.has_value())
+                    union_decl_sets(*first, idx);
+                else
+                    first = idx;
+            }
+
+            if(first.has_value())
+                m_set_tables[find_decl_set(*first)] = i;
+        }
+
         util::logfmt("pql::eval::solver", "Solver after preprocessing {}", toString());
     }
 
@@ -770,33 +1585,25 @@ namespace pql::eval::solver
         ret += ")\n";
         return ret;
     }
-    IntTable Solver::getRetTbl()
+    const std::vector<JoinPlan>& Solver::getPlans() const
     {
-        START_BENCHMARK_TIMER("Create return table");
-        util::logfmt("pql::eval::solver", "Getting return table");
-        IntTable ret_table;
-        spa_assert(!m_return_decls.empty());
+        return m_plans;
+    }
 
-        auto return_decls = std::vector<const ast::Declaration*>(m_return_decls.begin(), m_return_decls.end());
-        std::sort(return_decls.begin(), return_decls.end(), [&](auto& a, auto& b) -> bool {
-            return m_int_tables[get_table_index(a)].size() < m_int_tables[get_table_index(b)].size();
-        });
+    std::vector<const IntTable*> Solver::getRetTbls() const
+    {
+        spa_assert(!m_return_decls.empty());
 
-        for(const ast::Declaration* decl : return_decls)
+        std::vector<const IntTable*> ret {};
+        for(const IntTable& tbl : m_int_tables)
         {
-            util::logfmt("pql::eval::solver", "Handling return decl {}", decl->toString());
-            // already added into table by another decl in the same component
-            if(ret_table.getHeaders().count(decl))
-                continue;
-
-            IntTable& decl_int_table = m_int_tables[get_table_index(decl)];
-
-            util::logfmt(
-                "pql::eval::solver", "Merging table {} to {}", ret_table.toString(), decl_int_table.toString());
+            bool has_return_decl = std::any_of(tbl.getHeaders().begin(), tbl.getHeaders().end(),
+                [this](auto decl) -> bool { return m_return_decls.count(decl) > 0; });
 
-            ret_table.merge(decl_int_table);
+            if(has_return_decl)
+                ret.push_back(&tbl);
         }
-        util::logfmt("pql::eval::solver", "Return table: {}", ret_table.toString());
-        return ret_table;
+
+        return ret;
     }
 }
@@ -4,6 +4,9 @@
 
 #include <unordered_set>
 #include <numeric>
+#include <algorithm>
+#include <limits>
+#include <charconv>
 
 #include "zpr.h"
 #include "timer.h"
@@ -24,10 +27,92 @@ namespace pql::eval::table
         { EntryType::kConst, "Const" },
     };
 
-    Entry::Entry(const pql::ast::Declaration* declaration, const std::string& val)
+    static DeclarationIndices& default_declaration_indices()
     {
-        this->m_declaration = declaration;
-        this->m_val = val;
+        static thread_local DeclarationIndices indices {};
+        return indices;
+    }
+
+    static thread_local DeclarationIndices* current_declaration_indices = nullptr;
+
+    static DeclarationIndices& current_indices()
+    {
+        if(current_declaration_indices == nullptr)
+            return default_declaration_indices();
+
+        return *current_declaration_indices;
+    }
+
+    uint16_t DeclarationIndices::indexOf(const ast::Declaration* decl)
+    {
+        if(decl == nullptr)
+            return 0;
+
+        // a query only has a few dozen declarations at most, so just look through them. entries tend to be
+        // made for the same declaration many times in a row, so try the last one first.
+        if(m_last < m_decls.size() && m_decls[m_last] == decl)
+            return m_last;
+
+        for(size_t i = 1; i < m_decls.size(); i++)
+        {
+            if(m_decls[i] == decl)
+            {
+                m_last = static_cast<uint16_t>(i);
+                return m_last;
+            }
+        }
+
+        if(m_decls.size() > std::numeric_limits<uint16_t>::max())
+            throw util::PqlException("pql::eval::table", "too many declarations");
+
+        m_last = static_cast<uint16_t>(m_decls.size());
+        m_decls.push_back(decl);
+        return m_last;
+    }
+
+    const ast::Declaration* DeclarationIndices::at(uint16_t index) const
+    {
+        spa_assert(index < m_decls.size());
+        return m_decls[index];
+    }
+
+    void DeclarationIndices::clear()
+    {
+        m_decls.resize(1);
+        m_last = 0;
+    }
+
+    DeclarationIndexScope::DeclarationIndexScope(DeclarationIndices* indices)
+        : m_previous(current_declaration_indices)
+    {
+        current_declaration_indices = indices;
+    }
+
+    DeclarationIndexScope::~DeclarationIndexScope()
+    {
+        current_declaration_indices = m_previous;
+    }
+
+    uint16_t getDeclarationIndex(const ast::Declaration* decl)
+    {
+        return current_indices().indexOf(decl);
+    }
+
+    const ast::Declaration* getDeclarationAt(uint16_t index)
+    {
+        return current_indices().at(index);
+    }
+
+    void resetDeclarationIndices()
+    {
+        current_indices().clear();
+    }
+
+    Entry::Entry(const pql::ast::Declaration* declaration, size_t val)
+    {
+        spa_assert(val <= std::numeric_limits<uint32_t>::max());
+        this->m_decl = table::getDeclarationIndex(declaration);
+        this->m_val = static_cast<uint32_t>(val);
         switch(declaration->design_ent)
         {
             case ast::DESIGN_ENT::VARIABLE:
@@ -40,36 +125,24 @@ namespace pql::eval::table
                 this->m_type = EntryType::kConst;
                 break;
             default:
-                throw util::PqlException("pql::eval::table::Entry",
-                    "Entry for {} should be instantiated using stmt num instead of string", declaration->toString());
+                this->m_type = EntryType::kStmt;
+                break;
         }
     }
 
-    Entry::Entry(const pql::ast::Declaration* declaration, const std::string& val, EntryType type)
+    Entry::Entry(const pql::ast::Declaration* declaration, size_t val, EntryType type)
     {
-        this->m_declaration = declaration;
-        this->m_val = val;
+        spa_assert(val <= std::numeric_limits<uint32_t>::max());
+        this->m_decl = table::getDeclarationIndex(declaration);
+        this->m_val = static_cast<uint32_t>(val);
         this->m_type = type;
     }
 
-    Entry::Entry(const pql::ast::Declaration* declaration, const simple::ast::StatementNum& val)
-    {
-        if(declaration->design_ent == ast::DESIGN_ENT::VARIABLE ||
-            declaration->design_ent == ast::DESIGN_ENT::PROCEDURE ||
-            declaration->design_ent == ast::DESIGN_ENT::CONSTANT)
-        {
-            throw util::PqlException("pql::eval::table::Entry",
-                "Entry for {} should be instantiated using string instead of stmt num", declaration->toString());
-        }
-        this->m_declaration = declaration;
-        this->m_type = EntryType::kStmt;
-        this->m_stmt_num = val;
-    }
-    std::string Entry::getVal() const
+    uint32_t Entry::getId() const
     {
         if(this->m_type == EntryType::kStmt)
         {
-            throw util::PqlException("pql::eval::table::Entry", "Cannot getVal for statement entry");
+            throw util::PqlException("pql::eval::table::Entry", "Cannot getId for statement entry");
         }
         return this->m_val;
     }
@@ -79,7 +152,7 @@ namespace pql::eval::table
         {
             throw util::PqlException("pql::eval::table::Entry", "Cannot getStmtNum for non-statement entry");
         }
-        return this->m_stmt_num;
+        return this->m_val;
     }
     EntryType Entry::getType() const
     {
@@ -87,26 +160,19 @@ namespace pql::eval::table
     }
     const ast::Declaration* Entry::getDeclaration() const
     {
-        return this->m_declaration;
+        return getDeclarationAt(this->m_decl);
     }
-    std::string Entry::toString() const
+    uint16_t Entry::getDeclarationIndex() const
     {
-        return zpr::sprint("Entry(val:{}, stmt_num:{}, type:{}, declaration:{})", m_val, m_stmt_num,
-            EntryTypeString.count(m_type) ? EntryTypeString.find(m_type)->second : "not found",
-            m_declaration->toString());
+        return this->m_decl;
     }
-    bool Entry::operator==(const Entry& other) const
-    {
-        return this->m_type == other.getType() && this->m_declaration == other.getDeclaration() &&
-               ((this->m_type == EntryType::kStmt && this->m_stmt_num == other.getStmtNum()) ||
-                   (this->m_type != EntryType::kStmt && this->m_val == other.getVal()));
-    }
-    bool Entry::operator!=(const Entry& other) const
+    std::string Entry::toString() const
     {
-        return !(*this == other);
+        return zpr::sprint("Entry(val:{}, type:{}, declaration:{})", m_val,
+            EntryTypeString.count(m_type) ? EntryTypeString.find(m_type)->second : "not found",
+            this->getDeclaration()->toString());
     }
 
-
     int Join::get_next_id()
     {
         static int next_id = 0;
@@ -132,13 +198,88 @@ namespace pql::eval::table
         }
         this->m_decl_a = decl_a;
         this->m_decl_b = decl_b;
-        this->m_allowed_entries = allowed_entries;
+        this->setAllowedEntries(std::move(allowed_entries));
         this->m_id = Join::get_next_id();
         util::logfmt("pql::eval::table::join", "Creating join with id {}", this->m_id);
     }
+    Join::Join(pql::ast::Declaration* decl_a, pql::ast::Declaration* decl_b, JoinRelation relation, size_t num_pairs)
+        : Join(decl_a, decl_b, std::unordered_set<std::pair<Entry, Entry>> {})
+    {
+        spa_assert(relation.holds && relation.forward && relation.reverse);
+        this->m_relation = std::make_shared<const JoinRelation>(std::move(relation));
+        this->m_num_pairs = num_pairs;
+    }
+
     bool Join::isAllowedEntry(const std::pair<Entry, Entry>& entry) const
     {
-        return m_allowed_entries.count(entry) > 0;
+        if(this->isLazy())
+            return m_relation->holds(entry.first, entry.second);
+
+        return m_allowed_entries->count(entry) > 0;
+    }
+
+    bool Join::isLazy() const
+    {
+        return m_relation != nullptr;
+    }
+
+    size_t Join::size() const
+    {
+        return this->isLazy() ? m_num_pairs : m_allowed_entries->size();
+    }
+
+    void Join::setLazySize(size_t num_pairs)
+    {
+        spa_assert(this->isLazy());
+        m_num_pairs = num_pairs;
+    }
+
+    std::vector<Entry> Join::getPartners(const Entry& entry) const
+    {
+        spa_assert(this->isLazy());
+        spa_assert(entry.getDeclaration() == m_decl_a || entry.getDeclaration() == m_decl_b);
+
+        if(entry.getDeclaration() == m_decl_a)
+            return m_relation->forward(entry);
+        else
+            return m_relation->reverse(entry);
+    }
+
+    void Join::materialise(const Domain& domain_a, const Domain& domain_b)
+    {
+        if(!this->isLazy())
+            return;
+
+        START_BENCHMARK_TIMER(zpr::sprint("materialising join {} (~{} pairs)", m_id, m_num_pairs));
+
+        std::unordered_set<std::pair<Entry, Entry>> allowed_entries {};
+        allowed_entries.reserve(m_num_pairs);
+        if(domain_a.size() <= domain_b.size())
+        {
+            for(const auto& a : domain_a)
+            {
+                for(const auto& b : m_relation->forward(a))
+                {
+                    if(domain_b.count(b) > 0)
+                        allowed_entries.insert({ a, b });
+                }
+            }
+        }
+        else
+        {
+            for(const auto& b : domain_b)
+            {
+                for(const auto& a : m_relation->reverse(b))
+                {
+                    if(domain_a.count(a) > 0)
+                        allowed_entries.insert({ a, b });
+                }
+            }
+        }
+
+        this->setAllowedEntries(std::move(allowed_entries));
+        m_relation.reset();
+        m_num_pairs = 0;
     }
 
     pql::ast::Declaration* Join::getDeclA() const
@@ -153,24 +294,40 @@ namespace pql::eval::table
 
     const std::unordered_set<std::pair<Entry, Entry>>& Join::getAllowedEntries() const
     {
-        return this->m_allowed_entries;
+        spa_assert(!this->isLazy());
+        return *this->m_allowed_entries;
     }
 
-    std::unordered_set<std::pair<Entry, Entry>>& Join::getAllowedEntries()
+    std::unordered_set<std::pair<Entry, Entry>>& Join::editAllowedEntries()
     {
-        return this->m_allowed_entries;
+        spa_assert(!this->isLazy());
+        if(this->m_allowed_entries.use_count() > 1)
+        {
+            util::logfmt("pql::eval::table::join", "Copying {} shared pairs of join {}", this->size(), this->m_id);
+            BENCHMARK_COUNT("join pair sets copied", 1);
+            BENCHMARK_COUNT("join pairs copied", this->size());
+            this->m_allowed_entries =
+                std::make_shared<std::unordered_set<std::pair<Entry, Entry>>>(*this->m_allowed_entries);
+        }
+        return *this->m_allowed_entries;
     }
 
-    void Join::setAllowedEntries(const std::unordered_set<std::pair<Entry, Entry>>& allowed_entries)
+    void Join::setAllowedEntries(std::unordered_set<std::pair<Entry, Entry>> allowed_entries)
     {
-        this->m_allowed_entries = allowed_entries;
+        BENCHMARK_COUNT("join pair sets allocated", 1);
+        BENCHMARK_COUNT("join pairs allocated", allowed_entries.size());
+        this->m_allowed_entries =
+            std::make_shared<std::unordered_set<std::pair<Entry, Entry>>>(std::move(allowed_entries));
     }
 
     std::string Join::toString() const
     {
         std::string ret = zpr::sprint("Join(m_decl_a={}, m_decl_b={}", m_decl_a->toString(), m_decl_b->toString());
+        if(this->isLazy())
+            return ret + zpr::sprint(", lazy with {} pairs)", m_num_pairs);
+
         ret += "\n\tm_allowed_entries=[\n";
-        for(auto [entry_a, entry_b] : m_allowed_entries)
+        for(auto [entry_a, entry_b] : *m_allowed_entries)
         {
             ret += zpr::sprint("(\t\tdecl_a={}, decl_b={})\n", entry_a.toString(), entry_b.toString());
         }
@@ -183,14 +340,89 @@ namespace pql::eval::table
     Table::~Table() { }
 
 
+    void Table::setDomainInitialiser(DomainInitialiser initialiser, DomainMembership membership)
+    {
+        m_domain_initialiser = std::move(initialiser);
+        m_domain_membership = std::move(membership);
+    }
+
+    void Table::declareDomain(const ast::Declaration* decl)
+    {
+        spa_assert(m_domain_initialiser && m_domain_membership);
+        if(m_domains.count(decl) == 0)
+            m_lazy_domains.insert(decl);
+    }
+
+    void Table::buildDomain(const ast::Declaration* decl)
+    {
+        if(m_lazy_domains.erase(decl) == 0)
+            return;
+
+        START_BENCHMARK_TIMER(zpr::sprint("building initial domain of {}", decl->toString()));
+        m_domains[decl] = m_domain_initialiser(decl);
+    }
+
+    bool Table::hasBuiltDomain(const ast::Declaration* decl) const
+    {
+        return m_lazy_domains.count(decl) == 0;
+    }
+
     void Table::putDomain(const ast::Declaration* decl, Domain entries)
     {
         util::logfmt("pql::eval::table", "Updating domain of {} with {} entries", decl->toString(), entries.size());
+        m_lazy_domains.erase(decl);
         m_domains[decl] = std::move(entries);
     }
-    void Table::addJoin(const Join& join)
+
+    void Table::narrowDomain(const ast::Declaration* decl, Domain candidates)
     {
-        m_joins.push_back(join);
+        if(this->hasBuiltDomain(decl))
+        {
+            auto& domain = m_domains[decl];
+            // keep whichever of the two is smaller, and only look things up in the other one.
+            if(candidates.size() < domain.size())
+            {
+                for(auto it = candidates.begin(); it != candidates.end();)
+                {
+                    if(domain.count(*it) > 0)
+                        ++it;
+                    else
+                        it = candidates.erase(it);
+                }
+                domain = std::move(candidates);
+            }
+            else
+            {
+                this->filterDomain(
+                    decl, [&candidates](const Entry& entry) -> bool { return candidates.count(entry) > 0; });
+            }
+            return;
+        }
+
+        // the domain was never built, so it is implicitly everything; just drop the candidates
+        // that would not have been in it.
+        for(auto it = candidates.begin(); it != candidates.end();)
+        {
+            if(m_domain_membership(*it))
+                ++it;
+            else
+                it = candidates.erase(it);
+        }
+
+        this->putDomain(decl, std::move(candidates));
+    }
+
+    bool Table::domainContains(const ast::Declaration* decl, const Entry& entry) const
+    {
+        if(m_lazy_domains.count(decl) > 0)
+            return m_domain_membership(entry);
+
+        auto it = m_domains.find(decl);
+        return it != m_domains.end() && it->second.count(entry) > 0;
+    }
+    void Table::addJoin(Join join)
+    {
+        m_joins.push_back(std::move(join));
     }
 
     void Table::addSelectDecl(const ast::Declaration* decl)
@@ -199,20 +431,23 @@ namespace pql::eval::table
         m_select_decls.insert(decl);
     }
 
-    std::unordered_set<Entry> Table::getDomain(const ast::Declaration* decl) const
+    const Domain& Table::getDomain(const ast::Declaration* decl)
     {
+        static const Domain empty_domain {};
+        this->buildDomain(decl);
+
         auto it = m_domains.find(decl);
         if(it == m_domains.end())
-            return std::unordered_set<Entry>();
+            return empty_domain;
         return it->second;
     }
 
-    bool Table::hasValidDomain() const
+    bool Table::hasValidDomain()
     {
         for(const ast::Declaration* decl : m_select_decls)
         {
             util::logfmt("pql::eval::table", "Checking if {} has non empty domain", decl->toString());
-            std::unordered_set<Entry> domain = getDomain(decl);
+            const auto& domain = getDomain(decl);
             // All declarations should have at least one entry in domain
             if(domain.empty())
             {
@@ -244,7 +479,7 @@ namespace pql::eval::table
                         "Stmt at {} has empty call proc name. Make sure that the stmt is call stmt and the callee "
                         "proc_name has been properly populated",
                         entry.getStmtNum());
-                extracted_entry = Entry(decl, proc_name, EntryType::kProc);
+                extracted_entry = Entry(decl, pkb->getProcedureNamed(proc_name).getId(), EntryType::kProc);
             }
             else if(decl->design_ent == ast::DESIGN_ENT::PROCEDURE)
             {
@@ -268,11 +503,13 @@ namespace pql::eval::table
                 const simple::ast::PrintStmt* ast_print_stmt = dynamic_cast<const simple::ast::PrintStmt*>(ast_stmt);
                 if(ast_read_stmt)
                 {
-                    extracted_entry = Entry(decl, ast_read_stmt->var_name, EntryType::kVar);
+                    extracted_entry =
+                        Entry(decl, pkb->getVariableNamed(ast_read_stmt->var_name).getId(), EntryType::kVar);
                 }
                 else if(ast_print_stmt)
                 {
-                    extracted_entry = Entry(decl, ast_print_stmt->var_name, EntryType::kVar);
+                    extracted_entry =
+                        Entry(decl, pkb->getVariableNamed(ast_print_stmt->var_name).getId(), EntryType::kVar);
                 }
                 else
                 {
@@ -317,152 +554,209 @@ namespace pql::eval::table
         return extracted_entry;
     }
 
-    static std::string format_row_to_output(
-        const solver::IntRow& row, const std::vector<ast::Elem>& return_tuple, const pkb::ProgramKB* pkb)
+    // this is the only place where ids are turned back into names.
+    static void append_entry_to_output(std::string& out, const Entry& entry, const pkb::ProgramKB* pkb)
     {
-        util::logfmt("pql::parser::table", "Extracting result from row: {}", row.toString());
+        switch(entry.getType())
+        {
+            case EntryType::kStmt: {
+                char buf[24] {};
+                auto [end, _] = std::to_chars(std::begin(buf), std::end(buf), entry.getStmtNum());
+                out.append(buf, end);
+                break;
+            }
+            case EntryType::kVar:
+                out += pkb->getVariableWithId(entry.getId()).getName();
+                break;
+            case EntryType::kProc:
+                out += pkb->getProcedureWithId(entry.getId()).getName();
+                break;
+            case EntryType::kConst:
+                out += pkb->getConstantWithId(entry.getId());
+                break;
+            default:
+                unreachable();
+        }
+    }
+
+    namespace
+    {
+        // the output of every row of one column, back to back in a single buffer
+        struct OutputColumn
+        {
+            std::string text;
+            std::vector<size_t> ends;
+
+            zst::str_view at(size_t row) const
+            {
+                size_t begin = row == 0 ? 0 : ends[row - 1];
+                return zst::str_view(text.data() + begin, ends[row] - begin);
+            }
+        };
+    }
 
-        size_t ctr = 0;
-        std::string ret {};
-        // ret.reserve(return_tuple.size() * 3);
+    // the result is the cross product of the component tables, which is only expanded here, one output row
+    // at a time. each element is converted to text once per row of its own table, not per output row, and
+    // every output row is written into the same buffer.
+    static void write_tables_to_output(const std::vector<const solver::IntTable*>& tables,
+        const std::vector<ast::Elem>& return_tuple, const pkb::ProgramKB* pkb, const Table::ResultSink& sink)
+    {
+        if(std::any_of(tables.begin(), tables.end(), [](auto tbl) -> bool { return tbl->empty(); }))
+            return;
 
-        for(const ast::Elem& elem : return_tuple)
+        std::vector<size_t> elem_tables(return_tuple.size());
+        std::vector<OutputColumn> elem_columns(return_tuple.size());
+        for(size_t i = 0; i < return_tuple.size(); i++)
         {
+            const ast::Elem& elem = return_tuple[i];
             spa_assert(elem.isAttrRef() || elem.isDeclaration());
             const ast::Declaration* decl = elem.isDeclaration() ? elem.declaration() : elem.attrRef().decl;
-            const auto& entry = row.getVal(decl);
 
-            if(elem.isDeclaration())
+            auto it = std::find_if(tables.begin(), tables.end(),
+                [decl](auto tbl) -> bool { return tbl->getHeaders().count(decl) > 0; });
+            spa_assert(it != tables.end());
+            elem_tables[i] = it - tables.begin();
+
+            const auto& column = (*it)->getColumn(decl);
+            auto& output = elem_columns[i];
+            output.ends.reserve(column.size());
+            for(const auto& entry : column)
             {
-                if(entry.getType() == EntryType::kStmt)
-                    ret += std::to_string(entry.getStmtNum());
+                if(elem.isDeclaration())
+                    append_entry_to_output(output.text, entry, pkb);
                 else
-                    ret += entry.getVal();
+                    append_entry_to_output(output.text, Table::extractAttr(entry, elem.attrRef(), pkb), pkb);
+
+                output.ends.push_back(output.text.size());
             }
-            else
+        }
+
+        // count through the row of every table, with the last table changing fastest
+        std::vector<size_t> rows(tables.size(), 0);
+        std::string buffer {};
+        while(true)
+        {
+            buffer.clear();
+            for(size_t i = 0; i < return_tuple.size(); i++)
             {
-                auto attr = Table::extractAttr(entry, elem.attrRef(), pkb);
-                if(attr.getType() == EntryType::kStmt)
-                    ret += std::to_string(attr.getStmtNum());
-                else
-                    ret += attr.getVal();
+                if(i > 0)
+                    buffer += ' ';
+
+                auto text = elem_columns[i].at(rows[elem_tables[i]]);
+                buffer.append(text.data(), text.size());
             }
+            sink(buffer);
 
-            if(ctr + 1 < return_tuple.size())
-                ret += " ";
+            size_t k = tables.size();
+            while(k > 0 && ++rows[k - 1] == tables[k - 1]->size())
+                rows[--k] = 0;
 
-            ctr++;
+            if(k == 0)
+                break;
         }
-
-        return ret;
     }
 
-    static bool check_conflicting_values(const Table::ValueAssignmentMap& values, const Entry& ent)
+    namespace
     {
-        if(auto it = values.find(ent.getDeclaration()); it != values.end())
-            return it->second != ent;
-        return false;
+        // a backtracking search for one assignment of values to the declarations of a component that satisfies
+        // all of its joins. declarations are numbered within the component, and the values that each one can
+        // still take (its live values) are kept at the front of its array. removing a value swaps it past the
+        // end of that prefix, so undoing a removal only needs the old length, which goes on the trail.
+        struct JoinSearch
+        {
+            struct Edge
+            {
+                size_t other;
+                const Join* join;
+                bool is_decl_a; // whether the declaration owning this edge is the join's decl_a
+            };
+
+            std::vector<std::vector<Entry>> values;
+            std::vector<size_t> num_live;
+            std::vector<std::vector<Edge>> edges;
+            std::vector<bool> assigned;
+            std::vector<std::pair<size_t, size_t>> trail;
+        };
     }
 
-    bool Table::evaluateJoinValues(ValueAssignmentMap& values, const ast::Declaration* this_decl, size_t join_idx,
-        const std::vector<const Join*>& joins, JoinIdSet& visited_joins, DeclJoinMap& join_map)
+    // after assigning the value to decl, remove the values of its unassigned neighbours that no longer have
+    // a partner (forward checking). returns false if some neighbour has no values left.
+    static bool forward_check(JoinSearch& search, size_t decl, const Entry& value)
     {
-        if(join_idx >= joins.size())
-            return true;
-
-        auto join = joins[join_idx];
-        if(visited_joins.count(join->getId()) > 0)
-            return this->evaluateJoinValues(values, this_decl, join_idx + 1, joins, visited_joins, join_map);
-
-        auto& allowed = join->getAllowedEntries();
-        if(allowed.empty())
-            return false;
-
-        auto decl_a = join->getDeclA();
-        auto decl_b = join->getDeclB();
-
-        visited_joins.insert(join->getId());
-
-        for(auto& [a, b] : allowed)
+        for(const auto& edge : search.edges[decl])
         {
-            // we need to special case (decl_a == decl_b) here, ie. if a join involves the same decl twice
-            // if the values are not the same, then we skip this immediately.
-            if(decl_a == decl_b && a != b)
+            if(edge.other == decl)
+            {
+                if(!edge.join->isAllowedEntry({ value, value }))
+                    return false;
                 continue;
+            }
 
-            if(check_conflicting_values(values, a) || check_conflicting_values(values, b))
+            // an assigned neighbour already removed every value of ours that did not agree with it
+            if(search.assigned[edge.other])
                 continue;
 
-            if(m_domains[decl_a].count(a) == 0 || m_domains[decl_b].count(b) == 0)
-                continue;
+            auto& values = search.values[edge.other];
+            size_t old_live = search.num_live[edge.other];
+            size_t live = old_live;
+            for(size_t i = 0; i < live;)
+            {
+                auto pair = edge.is_decl_a ? std::make_pair(value, values[i]) : std::make_pair(values[i], value);
+                if(edge.join->isAllowedEntry(pair))
+                    i++;
+                else
+                    std::swap(values[i], values[--live]);
+            }
 
-            auto other_decl = (this_decl == decl_a ? decl_b : decl_a);
-
-            auto values_copy = values;
-            values_copy[decl_a] = a;
-            values_copy[decl_b] = b;
-
-            /*
-                we need to make a copy here, because both `recursivelyTraverseJoins` and `evaluateJoinValues`
-                can potentially add decl values to the value assignment. if they fail at some deeper depth,
-                we have no way of knowing which decl assignments to remove, causing backtracking failure.
-
-                by making a copy (and just assigning the copy if we succeed, or yeeting it if we fail), we
-                avoid this problem entirely.
-            */
-            auto visited_copy = visited_joins;
-
-            /*
-                These two functions are actually mutually recursive. This is because if a declaration has more
-                than one join that involves it, then we need a way to backtrack and retry the first join
-                if the second join fails.
-
-                If we think of it as a tree DFS (which it is), then we need to ensure that we can retry all
-                prior branches (with a different assignment) if a given branch fails; the recursive call to
-                `evaluateJoinValues` ensures that this can happen; a naive loop over joins would not let us
-                retry assignments from previous joins.
-            */
-            if(this->recursivelyTraverseJoins(values_copy, visited_copy, other_decl, join_map))
+            if(live != old_live)
             {
-                if(this->evaluateJoinValues(values_copy, this_decl, join_idx + 1, joins, visited_copy, join_map))
-                {
-                    values = std::move(values_copy);
-                    return true;
-                }
+                search.trail.emplace_back(edge.other, old_live);
+                search.num_live[edge.other] = live;
             }
+
+            if(live == 0)
+                return false;
         }
 
-        return false;
+        return true;
     }
 
-    bool Table::recursivelyTraverseJoins(
-        ValueAssignmentMap& values, JoinIdSet& visited_joins, const ast::Declaration* this_decl, DeclJoinMap& join_map)
+    static void undo_to(JoinSearch& search, size_t trail_size)
     {
-        spa_assert(join_map.count(this_decl) > 0);
-
-        if(m_domains[this_decl].empty())
-            return false;
-
-        return this->evaluateJoinValues(values, this_decl, 0, join_map[this_decl], visited_joins, join_map);
+        while(search.trail.size() > trail_size)
+        {
+            auto [decl, old_live] = search.trail.back();
+            search.num_live[decl] = old_live;
+            search.trail.pop_back();
+        }
     }
 
-    bool Table::validateAssignments(ValueAssignmentMap& values, const std::vector<Join>& joins)
+    static bool search_assignment(JoinSearch& search, size_t num_assigned)
     {
-        for(auto& join : joins)
+        if(num_assigned == search.values.size())
+            return true;
+
+        // assign the declaration with the fewest values left first, so dead ends are found early
+        size_t decl = search.values.size();
+        for(size_t i = 0; i < search.values.size(); i++)
         {
-            auto decl_a = join.getDeclA();
-            auto decl_b = join.getDeclB();
+            if(!search.assigned[i] && (decl == search.values.size() || search.num_live[i] < search.num_live[decl]))
+                decl = i;
+        }
 
-            // the joins might be involving other decls not in the current connected component, so
-            // ignore them for now.
-            if(values.count(decl_a) == 0 || values.count(decl_b) == 0)
-                continue;
+        // only the values of unassigned declarations are ever moved around, so this one's stay put
+        search.assigned[decl] = true;
+        for(size_t i = 0; i < search.num_live[decl]; i++)
+        {
+            size_t trail_size = search.trail.size();
+            if(forward_check(search, decl, search.values[decl][i]) && search_assignment(search, num_assigned + 1))
+                return true;
 
-            if(join.getAllowedEntries().count({ values.at(decl_a), values.at(decl_b) }) == 0)
-                return false;
+            undo_to(search, trail_size);
         }
 
-        return true;
+        search.assigned[decl] = false;
+        return false;
     }
 
     bool Table::evaluateJoinsOverDomains()
@@ -470,79 +764,60 @@ namespace pql::eval::table
         if(m_select_decls.empty())
             return true;
 
-        // make a vector of them, so we (a) can index, and (b) have a consistent order.
-        std::unordered_map<const ast::Declaration*, std::vector<const Join*>> join_mapping {};
-        for(auto& join : m_joins)
-        {
-            join_mapping[join.getDeclA()].push_back(&join);
-
-            // if the join involves the same decl (eg. Next(a, a)), don't add the join twice
-            if(join.getDeclA() != join.getDeclB())
-                join_mapping[join.getDeclB()].push_back(&join);
-        }
-
-        for(auto& [decl, joins] : join_mapping)
-        {
-            std::sort(joins.begin(), joins.end(), [](const auto* a, const auto* b) -> bool {
-                return a->getAllowedEntries().size() < b->getAllowedEntries().size();
-            });
-        }
-
         auto graph = solver::DepGraph(m_select_decls, m_joins);
-        auto components = graph.getComponents();
-
-        for(auto& comp : components)
+        for(auto& comp : graph.getComponents())
         {
-            ValueAssignmentMap assignments {};
             spa_assert(comp.size() > 0);
 
-            auto first_decl = *comp.begin();
-
-            if(join_mapping.count(first_decl) == 0)
+            JoinSearch search {};
+            std::unordered_map<const ast::Declaration*, size_t> indices {};
+            for(auto decl : comp)
             {
-                // if a decl has no joins, by definition it must be its own connected component.
-                spa_assert(comp.size() == 1);
+                indices[decl] = search.values.size();
+                search.values.emplace_back(m_domains[decl].begin(), m_domains[decl].end());
+                search.num_live.push_back(search.values.back().size());
 
-                // in this case, any value will do, so we continue to the next component as long
-                // as its domain is nonzero.
-                if(m_domains[first_decl].empty())
+                if(search.values.back().empty())
                     return false;
-
-                continue;
             }
 
-            std::unordered_set<int> visited_joins {};
-            if(!this->recursivelyTraverseJoins(assignments, visited_joins, first_decl, join_mapping))
-                return false;
+            search.edges.resize(comp.size());
+            search.assigned.resize(comp.size(), false);
+            for(const auto& join : m_joins)
+            {
+                if(comp.count(join.getDeclA()) == 0)
+                    continue;
+
+                auto a = indices[join.getDeclA()];
+                auto b = indices[join.getDeclB()];
+                search.edges[a].push_back(JoinSearch::Edge { b, &join, /* is_decl_a: */ true });
+                if(a != b)
+                    search.edges[b].push_back(JoinSearch::Edge { a, &join, /* is_decl_a: */ false });
+            }
 
-            // for sanity, verify that the assignments we produced satisfy the join conditions.
-            // we only need to validate this connected component of decls, since other decls can't
-            // affect the correctness of this assignment (by definition).
-            if(!this->validateAssignments(assignments, m_joins))
+            if(!search_assignment(search, 0))
                 return false;
         }
 
         return true;
     }
 
-
-
-
-
-
-
-    std::list<std::string> Table::getFailedResult(const ast::ResultCl& result)
+    void Table::writeFailedResult(const ast::ResultCl& result, const ResultSink& sink)
     {
-        static const std::list<std::string> FalseResult = std::list<std::string> { "FALSE" };
-        return result.isBool() ? FalseResult : std::list<std::string> {};
+        if(result.isBool())
+            sink("FALSE");
     }
 
-    std::list<std::string> Table::getResult(const ast::ResultCl& result_cl, const pkb::ProgramKB* pkb)
+    void Table::writeResult(const ast::ResultCl& result_cl, const pkb::ProgramKB* pkb, const ResultSink& sink)
     {
         START_BENCHMARK_TIMER("Table get result");
         util::logfmt("pql::eval::table", "Starting to get {} for table {}.", result_cl.toString(), toString());
 
 
+        // the joins and the solver work on the full domains, so any that are still lazy have to be built now.
+        for(auto decl : m_select_decls)
+            this->buildDomain(decl);
+
         std::unordered_set<const ast::Declaration*> ret_cols;
         if(result_cl.isTuple())
         {
@@ -558,7 +833,11 @@ namespace pql::eval::table
                     ret_cols.insert(elem.attrRef().decl);
                 }
             }
+
+            for(auto decl : ret_cols)
+                this->buildDomain(decl);
         }
+
         else
         {
             static constexpr bool DFS_JOIN_IMPLEMENTATION = true;
@@ -569,47 +848,42 @@ namespace pql::eval::table
                 // skip traversing any joins for the trivial case.
                 for(auto decl : m_select_decls)
                     if(m_domains[decl].empty())
-                        return { "FALSE" };
+                        return sink("FALSE");
 
                 if(this->evaluateJoinsOverDomains())
-                    return { "TRUE" };
+                    return sink("TRUE");
 
                 else
-                    return { "FALSE" };
+                    return sink("FALSE");
             }
         }
 
         // we don't need the domains after this, so move it out.
         solver::Solver solver(
-            /* joins: */ m_joins, /* domains: */ std::move(m_domains), /* return_decls: */ ret_cols,
+            /* joins: */ std::move(m_joins), /* domains: */ std::move(m_domains), /* return_decls: */ ret_cols,
             /* select_decls: */ m_select_decls);
 
         if(solver.isValid())
         {
             if(result_cl.isBool())
-                return std::list<std::string> { "TRUE" };
+                return sink("TRUE");
         }
         else
         {
-            return Table::getFailedResult(result_cl);
+            return Table::writeFailedResult(result_cl, sink);
         }
 
-        solver::IntTable ret_tbl = solver.getRetTbl();
-        if(ret_tbl.empty())
+        // the components are independent, so they are kept apart and only expanded into output rows.
+        auto ret_tbls = solver.getRetTbls();
+        if(std::any_of(ret_tbls.begin(), ret_tbls.end(), [](auto tbl) -> bool { return tbl->empty(); }))
         {
-            return Table::getFailedResult(result_cl);
+            return Table::writeFailedResult(result_cl, sink);
         }
 
-        std::list<std::string> result {};
         {
             START_BENCHMARK_TIMER("converting rows to strings");
-            auto result_tup = result_cl.tuple();
-
-            for(auto& row : ret_tbl.getRows())
-                result.push_back(format_row_to_output(row, result_tup, pkb));
+            write_tables_to_output(ret_tbls, result_cl.tuple(), pkb, sink);
         }
-
-        return result;
     }
 
 
@@ -17,23 +17,23 @@ namespace pql::eval
     {
         const char* relationName = nullptr;
 
-        const std::unordered_set<std::string>& (*getStmtRelatedVariables)(const Statement&) {};
+        const VarIdSet& (*getStmtRelatedVariables)(const Statement&) {};
 
-        // proc.getUsedVariables/getModifiedVariables
-        const std::unordered_set<std::string>& (*getProcRelatedVariables)(const Procedure&) {};
+        // proc.getUsedVariableIds/getModifiedVariableIds
+        const VarIdSet& (*getProcRelatedVariables)(const Procedure&) {};
 
-        // var.getUsingProcs/getModifyingProcs
-        const std::unordered_set<std::string>& (*getVariableRelatedProcs)(const Variable&) {};
+        // var.getUsingProcIds/getModifyingProcIds
+        const ProcIdSet& (*getVariableRelatedProcs)(const Variable&) {};
 
         StatementSet (*getVariableRelatedStmts)(const Variable&, ast::DESIGN_ENT) {};
 
-        bool (*procedureRelatesVariable)(const Procedure&, const std::string&) {};
-        bool (*statementRelatesVariable)(const Statement&, const std::string&) {};
+        bool (*procedureRelatesVariable)(const Procedure&, VarId) {};
+        bool (*statementRelatesVariable)(const Statement&, VarId) {};
 
-        void evaluateS(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const ast::StmtRef& stmt,
+        bool evaluateS(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const ast::StmtRef& stmt,
             const ast::EntRef& right) const;
 
-        void evaluateP(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const ast::EntRef& proc,
+        bool evaluateP(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel, const ast::EntRef& proc,
             const ast::EntRef& right) const;
     };
 }
@@ -43,7 +43,7 @@ namespace pql::ast
     using namespace pkb;
     namespace table = pql::eval::table;
 
-    void UsesP::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool UsesP::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         static auto abs = []() -> auto
         {
@@ -51,24 +51,24 @@ namespace pql::ast
             abs.relationName = "UsesP";
 
             abs.getProcRelatedVariables = [](const Procedure& p) -> decltype(auto) {
-                return p.getUsedVariables();
+                return p.getUsedVariableIds();
             };
 
             abs.getVariableRelatedProcs = [](const Variable& v) -> decltype(auto) {
-                return v.getUsingProcNames();
+                return v.getUsingProcIds();
             };
 
-            abs.procedureRelatesVariable = [](const Procedure& p, const std::string& s) -> bool {
-                return p.usesVariable(s);
+            abs.procedureRelatesVariable = [](const Procedure& p, VarId v) -> bool {
+                return p.usesVariable(v);
             };
             return abs;
         }
         ();
 
-        abs.evaluateP(pkb, tbl, this, this->user, this->ent);
+        return abs.evaluateP(pkb, tbl, this, this->user, this->ent);
     }
 
-    void UsesS::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool UsesS::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         static auto abs = []() -> auto
         {
@@ -76,24 +76,24 @@ namespace pql::ast
             abs.relationName = "UsesS";
 
             abs.getStmtRelatedVariables = [](const Statement& s) -> decltype(auto) {
-                return s.getUsedVariables();
+                return s.getUsedVariableIds();
             };
 
             abs.getVariableRelatedStmts = [](const Variable& v, ast::DESIGN_ENT ent) -> decltype(auto) {
                 return v.getUsingStmtNumsFiltered(ent);
             };
 
-            abs.statementRelatesVariable = [](const Statement& s, const std::string& v) -> bool {
+            abs.statementRelatesVariable = [](const Statement& s, VarId v) -> bool {
                 return s.usesVariable(v);
             };
             return abs;
         }
         ();
 
-        abs.evaluateS(pkb, tbl, this, this->user, this->ent);
+        return abs.evaluateS(pkb, tbl, this, this->user, this->ent);
     }
 
-    void ModifiesP::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool ModifiesP::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         static auto abs = []() -> auto
         {
@@ -101,24 +101,24 @@ namespace pql::ast
             abs.relationName = "ModifiesP";
 
             abs.getProcRelatedVariables = [](const Procedure& p) -> decltype(auto) {
-                return p.getModifiedVariables();
+                return p.getModifiedVariableIds();
             };
 
             abs.getVariableRelatedProcs = [](const Variable& v) -> decltype(auto) {
-                return v.getModifyingProcNames();
+                return v.getModifyingProcIds();
             };
 
-            abs.procedureRelatesVariable = [](const Procedure& p, const std::string& s) -> bool {
-                return p.modifiesVariable(s);
+            abs.procedureRelatesVariable = [](const Procedure& p, VarId v) -> bool {
+                return p.modifiesVariable(v);
             };
             return abs;
         }
         ();
 
-        abs.evaluateP(pkb, tbl, this, this->modifier, this->ent);
+        return abs.evaluateP(pkb, tbl, this, this->modifier, this->ent);
     }
 
-    void ModifiesS::evaluate(const ProgramKB* pkb, table::Table* tbl) const
+    bool ModifiesS::evaluate(const ProgramKB* pkb, table::Table* tbl) const
     {
         static auto abs = []() -> auto
         {
@@ -126,21 +126,21 @@ namespace pql::ast
             abs.relationName = "ModifiesS";
 
             abs.getStmtRelatedVariables = [](const Statement& s) -> decltype(auto) {
-                return s.getModifiedVariables();
+                return s.getModifiedVariableIds();
             };
 
             abs.getVariableRelatedStmts = [](const Variable& v, ast::DESIGN_ENT ent) -> decltype(auto) {
                 return v.getModifyingStmtNumsFiltered(ent);
             };
 
-            abs.statementRelatesVariable = [](const Statement& s, const std::string& v) -> bool {
+            abs.statementRelatesVariable = [](const Statement& s, VarId v) -> bool {
                 return s.modifiesVariable(v);
             };
             return abs;
         }
         ();
 
-        abs.evaluateS(pkb, tbl, this, this->modifier, this->ent);
+        return abs.evaluateS(pkb, tbl, this, this->modifier, this->ent);
     }
 }
 
@@ -154,7 +154,7 @@ namespace pql::ast
 namespace pql::eval
 {
     // Uses/ModifiesP
-    void UsesModifiesRelationAbstractor::evaluateP(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel,
+    bool UsesModifiesRelationAbstractor::evaluateP(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel,
         const ast::EntRef& proc_ent, const ast::EntRef& var_ent) const
     {
         spa_assert(rel);
@@ -181,8 +181,12 @@ namespace pql::eval
             auto var_name = var_ent.name();
 
             util::logfmt("pql::eval", "Processing {}(EntName, EntName)", this->relationName);
-            if(!this->procedureRelatesVariable(pkb->getProcedureNamed(proc_name), var_name))
-                throw PqlException("pql::eval", "{} is always false", rel->toString(), var_name);
+            auto var = pkb->getVariableNamed(var_name).getId();
+            if(!this->procedureRelatesVariable(pkb->getProcedureNamed(proc_name), var))
+            {
+                util::logfmt("pql::eval", "{} is always false", rel->toString(), var_name);
+                return false;
+            }
         }
         else if(proc_ent.isName() && var_ent.isDeclaration())
         {
@@ -193,14 +197,16 @@ namespace pql::eval
 
             auto& used_vars = this->getProcRelatedVariables(pkb->getProcedureNamed(proc_name));
             if(used_vars.empty())
-                throw PqlException("pql::eval", "{} is always false; {} doesn't use any variables", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} is always false; {} doesn't use any variables", rel->toString());
+                return false;
+            }
 
             std::unordered_set<table::Entry> new_domain {};
-            for(const auto& var : used_vars)
+            for(auto var : used_vars)
                 new_domain.emplace(var_decl, var);
 
-            auto old_domain = table->getDomain(var_decl);
-            table->putDomain(var_decl, table::entry_set_intersect(old_domain, new_domain));
+            table->narrowDomain(var_decl, std::move(new_domain));
         }
         else if(proc_ent.isName() && var_ent.isWildcard())
         {
@@ -209,7 +215,10 @@ namespace pql::eval
             util::logfmt("pql::eval", "Processing {}(EntName, _)", this->relationName);
             auto& used_vars = this->getProcRelatedVariables(pkb->getProcedureNamed(proc_name));
             if(used_vars.empty())
-                throw PqlException("pql::eval", "{} is always false; {} doesn't use any variables", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} is always false; {} doesn't use any variables", rel->toString());
+                return false;
+            }
         }
 
         else if(proc_ent.isDeclaration() && var_ent.isName())
@@ -221,15 +230,16 @@ namespace pql::eval
 
             const auto& procs_using = this->getVariableRelatedProcs(pkb->getVariableNamed(var_name));
             if(procs_using.empty())
-                throw PqlException(
-                    "pql::eval", "{} is always false; {} no procedure uses '{}'", rel->toString(), var_name);
+            {
+                util::logfmt("pql::eval", "{} is always false; {} no procedure uses '{}'", rel->toString(), var_name);
+                return false;
+            }
 
             std::unordered_set<table::Entry> new_domain {};
-            for(const auto& proc_name : procs_using)
-                new_domain.emplace(proc_decl, proc_name);
+            for(auto proc : procs_using)
+                new_domain.emplace(proc_decl, proc);
 
-            auto old_domain = table->getDomain(proc_decl);
-            table->putDomain(proc_decl, table::entry_set_intersect(old_domain, new_domain));
+            table->narrowDomain(proc_decl, std::move(new_domain));
         }
         else if(proc_ent.isDeclaration() && var_ent.isDeclaration())
         {
@@ -238,9 +248,9 @@ namespace pql::eval
 
             util::logfmt("pql::eval", "Processing {}(DeclaredEnt, DeclaredStmt)", this->relationName);
 
-            evaluateTwoDeclRelations<std::string, std::string>(
-                pkb, table, rel, proc_decl, var_decl, [&](const std::string& p) -> decltype(auto) {
-                    return this->getProcRelatedVariables(pkb->getProcedureNamed(p));
+            evaluateTwoDeclRelations<ProcId, VarId>(
+                pkb, table, rel, proc_decl, var_decl, [&](const ProcId& p) -> decltype(auto) {
+                    return this->getProcRelatedVariables(pkb->getProcedureWithId(p));
                 });
         }
         else if(proc_ent.isDeclaration() && var_ent.isWildcard())
@@ -248,30 +258,23 @@ namespace pql::eval
             auto proc_decl = proc_ent.declaration();
 
             util::logfmt("pql::eval", "Processing {}(DeclaredEnt, _)", this->relationName);
-            std::unordered_set<table::Entry> new_domain {};
-
-            for(const auto& entry : table->getDomain(proc_decl))
-            {
-                auto& proc_used_vars = this->getProcRelatedVariables(pkb->getProcedureNamed(entry.getVal()));
-                if(proc_used_vars.empty())
-                    continue;
-
-                new_domain.insert(entry);
-            }
-
-            table->putDomain(proc_decl, table::entry_set_intersect(new_domain, table->getDomain(proc_decl)));
+            table->filterDomain(proc_decl, [&](const table::Entry& entry) -> bool {
+                return !this->getProcRelatedVariables(pkb->getProcedureWithId(entry.getId())).empty();
+            });
         }
         else
         {
             throw PqlException("pql::eval", "unreachable");
         }
+
+        return true;
     }
 
 
 
 
     // Uses/ModifiesS
-    void UsesModifiesRelationAbstractor::evaluateS(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel,
+    bool UsesModifiesRelationAbstractor::evaluateS(const ProgramKB* pkb, table::Table* table, const ast::RelCond* rel,
         const ast::StmtRef& user_stmt, const ast::EntRef& var_ent) const
     {
         spa_assert(rel);
@@ -298,8 +301,12 @@ namespace pql::eval
             auto var_name = var_ent.name();
 
             util::logfmt("pql::eval", "Processing {}(StmtId, EntName)", this->relationName);
-            if(!this->statementRelatesVariable(pkb->getStatementAt(user_sid), var_name))
-                throw PqlException("pql::eval", "{} is always false", rel->toString(), var_name);
+            auto var = pkb->getVariableNamed(var_name).getId();
+            if(!this->statementRelatesVariable(pkb->getStatementAt(user_sid), var))
+            {
+                util::logfmt("pql::eval", "{} is always false", rel->toString(), var_name);
+                return false;
+            }
         }
         else if(user_stmt.isStatementId() && var_ent.isDeclaration())
         {
@@ -309,10 +316,10 @@ namespace pql::eval
             util::logfmt("pql::eval", "Processing {}(StmtId, DeclaredEnt)", this->relationName);
             std::unordered_set<table::Entry> new_domain {};
 
-            for(const auto& var : this->getStmtRelatedVariables(pkb->getStatementAt(user_sid)))
+            for(auto var : this->getStmtRelatedVariables(pkb->getStatementAt(user_sid)))
                 new_domain.emplace(var_decl, var);
 
-            table->putDomain(var_decl, table::entry_set_intersect(new_domain, table->getDomain(var_decl)));
+            table->narrowDomain(var_decl, std::move(new_domain));
         }
         else if(user_stmt.isStatementId() && var_ent.isWildcard())
         {
@@ -320,7 +327,10 @@ namespace pql::eval
 
             util::logfmt("pql::eval", "Processing {}(StmtId, _)", this->relationName);
             if(this->getStmtRelatedVariables(pkb->getStatementAt(user_sid)).empty())
-                throw PqlException("pql::eval", "{} is always false", rel->toString());
+            {
+                util::logfmt("pql::eval", "{} is always false", rel->toString());
+                return false;
+            }
         }
         else if(user_stmt.isDeclaration() && var_ent.isName())
         {
@@ -336,7 +346,7 @@ namespace pql::eval
             for(auto sid : this->getVariableRelatedStmts(var, user_decl->design_ent))
                 new_domain.emplace(user_decl, sid);
 
-            table->putDomain(user_decl, table::entry_set_intersect(new_domain, table->getDomain(user_decl)));
+            table->narrowDomain(user_decl, std::move(new_domain));
         }
         else if(user_stmt.isDeclaration() && var_ent.isDeclaration())
         {
@@ -345,7 +355,7 @@ namespace pql::eval
 
             util::logfmt("pql::eval", "Processing {}(DeclaredStmt, DeclaredEnt)", this->relationName);
 
-            evaluateTwoDeclRelations<StatementNum, std::string>(
+            evaluateTwoDeclRelations<StatementNum, VarId>(
                 pkb, table, rel, user_decl, var_decl, [&](const StatementNum& s) -> decltype(auto) {
                     return this->getStmtRelatedVariables(pkb->getStatementAt(s));
                 });
@@ -355,22 +365,15 @@ namespace pql::eval
             auto user_decl = user_stmt.declaration();
 
             util::logfmt("pql::eval", "Processing {}(DeclaredStmt, _)", this->relationName);
-
-            std::unordered_set<table::Entry> new_domain {};
-            for(const auto& entry : table->getDomain(user_decl))
-            {
-                decltype(auto) used_vars = this->getStmtRelatedVariables(pkb->getStatementAt(entry.getStmtNum()));
-                if(used_vars.empty())
-                    continue;
-
-                new_domain.insert(entry);
-            }
-
-            table->putDomain(user_decl, table::entry_set_intersect(new_domain, table->getDomain(user_decl)));
+            table->filterDomain(user_decl, [&](const table::Entry& entry) -> bool {
+                return !this->getStmtRelatedVariables(pkb->getStatementAt(entry.getStmtNum())).empty();
+            });
         }
         else
         {
             throw PqlException("pql::eval", "unreachable");
         }
+
+        return true;
     }
 }
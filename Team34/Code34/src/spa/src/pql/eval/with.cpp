@@ -1,6 +1,7 @@
 // with.cpp
 
 #include <algorithm>
+#include <charconv>
 
 #include "exceptions.h"
 #include "pql/eval/table.h"
@@ -56,85 +57,136 @@ namespace pql::ast
     using Entry = table::Entry;
     using Domain = table::Domain;
 
+    // the statement with the given number, if there is one. numbers can be arbitrarily long in the source, so big
+    // ones might not even fit in an entry.
+    static std::optional<pkb::StatementNum> get_stmt_num(const std::string& number, const pkb::ProgramKB* pkb)
+    {
+        uint64_t stmt_num = 0;
+        auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), stmt_num);
+        if(ec != std::errc() || ptr != number.data() + number.size())
+            return std::nullopt;
+
+        if(stmt_num == 0 || stmt_num > pkb->getAllStatements().size())
+            return std::nullopt;
+
+        return stmt_num;
+    }
+
     static void handle_attrref_const(
         const WithCondRef* left, const WithCondRef* right, const pkb::ProgramKB* pkb, Table* tbl)
     {
         auto l_ref = left->attrRef();
         auto l_decl = l_ref.decl;
-        auto l_domain = tbl->getDomain(l_ref.decl);
 
         tbl->addSelectDecl(l_decl);
 
-        for(auto it = l_domain.begin(); it != l_domain.end();)
+        // names and constant values are compared by id, and statement numbers as numbers, so look up the
+        // right side once.
+        std::optional<uint32_t> right_id {};
+        if(l_ref.attr_name == AttrName::kStmtNum)
+        {
+            spa_assert(right->isNumber());
+            right_id = get_stmt_num(right->stringOrNumber(), pkb);
+        }
+        else if(l_ref.attr_name == AttrName::kValue)
+        {
+            spa_assert(right->isNumber());
+            right_id = pkb->maybeGetConstantId(right->stringOrNumber());
+        }
+        else if(l_ref.attr_name == AttrName::kProcName)
         {
-            auto attr = Table::extractAttr(*it, l_ref, pkb);
+            if(auto proc = pkb->maybeGetProcedureNamed(right->stringOrNumber()); proc != nullptr)
+                right_id = proc->getId();
+        }
+        else
+        {
+            spa_assert(l_ref.attr_name == AttrName::kVarName);
+            if(auto var = pkb->maybeGetVariableNamed(right->stringOrNumber()); var != nullptr)
+                right_id = var->getId();
+        }
 
-            bool equals = false;
-            if(l_ref.attr_name == AttrName::kValue)
-            {
-                spa_assert(right->isNumber());
-                equals = right->stringOrNumber() == attr.getVal();
-            }
-            else if(l_ref.attr_name == AttrName::kStmtNum)
-            {
-                // TODO: consider changing this to convert the string to a number, since
-                // (i think) that is potentially faster.
-                spa_assert(right->isNumber());
-                equals = right->stringOrNumber() == std::to_string(attr.getStmtNum());
-            }
-            else
-            {
-                spa_assert(l_ref.attr_name == AttrName::kProcName || l_ref.attr_name == AttrName::kVarName);
-                equals = right->stringOrNumber() == attr.getVal();
-            }
+        // a name or number that is not in the program matches nothing.
+        if(!right_id.has_value())
+            return tbl->narrowDomain(l_decl, {});
 
-            if(!equals)
-                it = l_domain.erase(it);
-            else
-                ++it;
-        }
+        // usually the entries of the synonym are the attribute itself, so the clause pins it to (at most) that
+        // one entry, and its domain does not need to be built. only the procName of calls and the varName of
+        // reads and prints have to be looked up from each statement.
+        bool entry_is_attr = l_ref.attr_name == AttrName::kStmtNum ||
+                             l_decl->design_ent == ast::DESIGN_ENT::CONSTANT ||
+                             l_decl->design_ent == ast::DESIGN_ENT::VARIABLE ||
+                             l_decl->design_ent == ast::DESIGN_ENT::PROCEDURE;
+
+        if(entry_is_attr)
+            return tbl->narrowDomain(l_decl, { Entry(l_decl, *right_id) });
 
-        tbl->putDomain(l_decl, std::move(l_domain));
+        tbl->filterDomain(l_decl, [&](const Entry& entry) -> bool {
+            return Table::extractAttr(entry, l_ref, pkb).getId() == *right_id;
+        });
     }
 
-    static void handle_ref_ref_consts(Domain l_domain, Domain r_domain, Declaration* l_decl, Declaration* r_decl,
+    static void handle_ref_ref_consts(const Domain& r_domain, Declaration* l_decl, Declaration* r_decl,
         ast::AttrName l_attr, ast::AttrName r_attr, const pkb::ProgramKB* pkb, Table* tbl)
     {
         std::unordered_set<std::pair<Entry, Entry>> join_pairs {};
         Domain new_r_domain {};
 
-        for(auto it = l_domain.begin(); it != l_domain.end();)
-        {
-            auto& e1 = *it;
-            Entry e2 {};
+        tbl->filterDomain(l_decl, [&](const Entry& e1) -> bool {
+            std::optional<Entry> e2 {};
             if(l_attr == r_attr)
             {
-                e2 = (r_attr == AttrName::kValue) ? Entry(r_decl, e1.getVal()) : Entry(r_decl, e1.getStmtNum());
-            }
-            else
-            {
-                e2 = (r_attr == AttrName::kValue) ? Entry(r_decl, std::to_string(e1.getStmtNum())) :
-                                                    Entry(r_decl, std::stoll(e1.getVal()));
+                e2 = (r_attr == AttrName::kValue) ? Entry(r_decl, e1.getId()) : Entry(r_decl, e1.getStmtNum());
             }
-
-
-            if(r_domain.count(e2) == 0)
+            else if(r_attr == AttrName::kValue)
             {
-                it = l_domain.erase(it);
+                // not every statement number is also a constant in the program.
+                if(auto const_id = pkb->maybeGetConstantId(std::to_string(e1.getStmtNum())); const_id.has_value())
+                    e2 = Entry(r_decl, *const_id);
             }
             else
             {
-                join_pairs.emplace(e1, e2);
-                new_r_domain.emplace(std::move(e2));
-                ++it;
+                // likewise, not every constant is a statement number.
+                if(auto stmt_num = get_stmt_num(pkb->getConstantWithId(e1.getId()), pkb); stmt_num.has_value())
+                    e2 = Entry(r_decl, *stmt_num);
             }
-        }
 
-        tbl->putDomain(l_decl, std::move(l_domain));
+
+            if(!e2.has_value() || r_domain.count(*e2) == 0)
+                return false;
+
+            join_pairs.emplace(e1, *e2);
+            new_r_domain.emplace(std::move(*e2));
+            return true;
+        });
+
         tbl->putDomain(r_decl, std::move(new_r_domain));
         tbl->addJoin(Join(l_decl, r_decl, std::move(join_pairs)));
     }
 
+    // procName and varName can be compared with each other, but procedures and variables are numbered
+    // separately, so going from one to the other has to go through the name.
+    static std::optional<pkb::ProcId> get_proc_id(const Entry& attr, const pkb::ProgramKB* pkb)
+    {
+        if(attr.getType() == table::EntryType::kProc)
+            return attr.getId();
+
+        if(auto proc = pkb->maybeGetProcedureNamed(pkb->getVariableWithId(attr.getId()).getName()); proc != nullptr)
+            return proc->getId();
+
+        return std::nullopt;
+    }
+
+    static std::optional<pkb::VarId> get_var_id(const Entry& attr, const pkb::ProgramKB* pkb)
+    {
+        if(attr.getType() == table::EntryType::kVar)
+            return attr.getId();
+
+        if(auto var = pkb->maybeGetVariableNamed(pkb->getProcedureWithId(attr.getId()).getName()); var != nullptr)
+            return var->getId();
+
+        return std::nullopt;
+    }
+
     // return true if there is some valid mapping of `lhs = rhs`. false if there isn't (and so
     // prune this particular lhs from the domain of lhs)
     using EntryPairSet = std::unordered_set<std::pair<Entry, Entry>>;
@@ -142,9 +194,13 @@ namespace pql::ast
         EntryPairSet& join_pairs, const Entry& lent, const Entry& lattrval, Declaration* r_decl,
         const pkb::ProgramKB* pkb, Table* tbl)
     {
+        auto proc_id = get_proc_id(lattrval, pkb);
+        if(!proc_id.has_value())
+            return false;
+
         if(r_decl->design_ent == DESIGN_ENT::PROCEDURE)
         {
-            auto e = Entry(r_decl, lattrval.getVal());
+            auto e = Entry(r_decl, *proc_id);
             if(old_r_domain.count(e) == 0)
                 return false;
 
@@ -154,12 +210,10 @@ namespace pql::ast
         }
         else if(r_decl->design_ent == DESIGN_ENT::CALL)
         {
-            auto proc = pkb->maybeGetProcedureNamed(lattrval.getVal());
-            if(proc == nullptr)
-                return false;
+            auto& proc = pkb->getProcedureWithId(*proc_id);
 
             bool has_valid_rhs = false;
-            for(auto& i : proc->getCallStmts())
+            for(auto& i : proc.getCallStmts())
             {
                 auto e = Entry(r_decl, i);
                 if(old_r_domain.count(e) == 0)
@@ -182,9 +236,13 @@ namespace pql::ast
         EntryPairSet& join_pairs, const Entry& lent, const Entry& lattrval, Declaration* r_decl,
         const pkb::ProgramKB* pkb, Table* tbl)
     {
+        auto var_id = get_var_id(lattrval, pkb);
+        if(!var_id.has_value())
+            return false;
+
         if(r_decl->design_ent == DESIGN_ENT::VARIABLE)
         {
-            auto e = Entry(r_decl, lattrval.getVal());
+            auto e = Entry(r_decl, *var_id);
             if(old_r_domain.count(e) == 0)
                 return false;
 
@@ -194,11 +252,8 @@ namespace pql::ast
         }
         else if(r_decl->design_ent == DESIGN_ENT::PRINT || r_decl->design_ent == DESIGN_ENT::READ)
         {
-            auto var = pkb->maybeGetVariableNamed(lattrval.getVal());
-            if(var == nullptr)
-                return false;
-
-            auto& rhses = r_decl->design_ent == DESIGN_ENT::PRINT ? var->getPrintStmts() : var->getReadStmts();
+            auto& var = pkb->getVariableWithId(*var_id);
+            auto& rhses = r_decl->design_ent == DESIGN_ENT::PRINT ? var.getPrintStmts() : var.getReadStmts();
 
             bool has_valid_rhs = false;
             for(auto& i : rhses)
@@ -228,11 +283,9 @@ namespace pql::ast
     {
         auto l_ref = left->attrRef();
         auto l_decl = l_ref.decl;
-        auto l_domain = tbl->getDomain(l_ref.decl);
 
         auto r_ref = right->attrRef();
         auto r_decl = r_ref.decl;
-        auto r_domain = tbl->getDomain(r_decl);
 
         tbl->addSelectDecl(l_decl);
         tbl->addSelectDecl(r_decl);
@@ -241,53 +294,47 @@ namespace pql::ast
         auto r_attr = r_ref.attr_name;
 
         // always iterate the smaller domain
-        if(r_domain.size() < l_domain.size())
+        if(tbl->getDomain(r_decl).size() < tbl->getDomain(l_decl).size())
         {
-            std::swap(l_domain, r_domain);
             std::swap(l_attr, r_attr);
             std::swap(l_decl, r_decl);
             std::swap(l_ref, r_ref);
         }
 
+        // the left domain is filtered in place while the right one is looked up, so if they are the same
+        // declaration, look things up in a copy of it instead.
+        std::optional<Domain> r_domain_copy {};
+        if(l_decl == r_decl)
+            r_domain_copy = tbl->getDomain(r_decl);
+
+        const Domain& r_domain = r_domain_copy ? *r_domain_copy : tbl->getDomain(r_decl);
+
         // same as the above with rhs=attrref, but this time we don't have the guarantee that
         // the left side is always a prog_line. this explodes the checking space.
         // instead of doing an O(n^2) check, special case all possible things.
         if((l_attr == AttrName::kValue || l_attr == AttrName::kStmtNum) &&
             (r_attr == AttrName::kValue || r_attr == AttrName::kStmtNum))
         {
-            handle_ref_ref_consts(std::move(l_domain), std::move(r_domain), l_decl, r_decl, l_attr, r_attr, pkb, tbl);
+            handle_ref_ref_consts(r_domain, l_decl, r_decl, l_attr, r_attr, pkb, tbl);
         }
         else
         {
             Domain new_r_domain {};
             std::unordered_set<std::pair<Entry, Entry>> join_pairs {};
-            for(auto it = l_domain.begin(); it != l_domain.end();)
-            {
-                bool should_keep = false;
-
-                auto lattrval = Table::extractAttr(*it, l_ref, pkb);
+            tbl->filterDomain(l_decl, [&](const Entry& entry) -> bool {
+                auto lattrval = Table::extractAttr(entry, l_ref, pkb);
                 if(r_attr == AttrName::kProcName)
-                {
-                    should_keep =
-                        handle_ref_right_procname(r_domain, new_r_domain, join_pairs, *it, lattrval, r_decl, pkb, tbl);
-                }
+                    return handle_ref_right_procname(
+                        r_domain, new_r_domain, join_pairs, entry, lattrval, r_decl, pkb, tbl);
+
                 else if(r_attr == AttrName::kVarName)
-                {
-                    should_keep =
-                        handle_ref_right_varname(r_domain, new_r_domain, join_pairs, *it, lattrval, r_decl, pkb, tbl);
-                }
-                else
-                {
-                    throw PqlException("pql::eval", "unreachable");
-                }
+                    return handle_ref_right_varname(
+                        r_domain, new_r_domain, join_pairs, entry, lattrval, r_decl, pkb, tbl);
 
-                if(should_keep)
-                    ++it;
                 else
-                    it = l_domain.erase(it);
-            }
+                    throw PqlException("pql::eval", "unreachable");
+            });
 
-            tbl->putDomain(l_decl, std::move(l_domain));
             tbl->putDomain(r_decl, std::move(new_r_domain));
             tbl->addJoin(Join(l_decl, r_decl, std::move(join_pairs)));
         }
@@ -295,7 +342,7 @@ namespace pql::ast
 
 
 
-    void WithCond::evaluate(const pkb::ProgramKB* pkb, Table* tbl) const
+    bool WithCond::evaluate(const pkb::ProgramKB* pkb, Table* tbl) const
     {
         if(get_type(this->lhs) != get_type(this->rhs))
             throw PqlException("pql::eval", "incompatible types for two sides of 'with'");
@@ -304,11 +351,14 @@ namespace pql::ast
         if((this->lhs.isString() || this->lhs.isNumber()) && (this->rhs.isString() || this->rhs.isNumber()))
         {
             if(this->lhs.stringOrNumber() != this->rhs.stringOrNumber())
-                throw PqlException(
+            {
+                util::logfmt(
                     "pql::eval", "'{}' = '{}' is always false", this->lhs.stringOrNumber(), this->rhs.stringOrNumber());
+                return false;
+            }
 
             // always true
-            return;
+            return true;
         }
 
         auto* left = &this->lhs;
@@ -337,5 +387,7 @@ namespace pql::ast
 
         else
             throw PqlException("pql::eval", "unreachable");
+
+        return true;
     }
 }
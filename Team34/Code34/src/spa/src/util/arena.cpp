@@ -1,9 +1,15 @@
 // arena.cpp
 
+#include <new>
 #include <cstdlib>
 #include <algorithm>
 
+#if defined(ENABLE_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 #include "arena.h"
+#include "timer.h"
 #include "exceptions.h"
 
 namespace util
@@ -11,81 +17,227 @@ namespace util
     // allocate in 256kb blocks.
     static constexpr size_t CHUNK_CAPCITY = 256 * 1024;
 
-    Arena& Arena::global()
+    // anything bigger than this gets a chunk of its own, so that it doesn't throw away the rest of the current one.
+    static constexpr size_t LARGE_ALLOCATION = CHUNK_CAPCITY / 4;
+
+    // chunks beyond this many bytes are freed on reset instead of being kept for the next query.
+    static constexpr size_t MAX_RETAINED_BYTES = 64 * 1024 * 1024;
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // how many ArenaScopes are alive on this thread
+    static thread_local size_t scope_depth = 0;
+
+    Arena& Arena::current()
     {
-        static Arena arena {};
+        static thread_local Arena arena {};
         return arena;
     }
 
-    static Arena::Chunk* make_new_chunk(size_t minimum)
+    Arena::~Arena()
     {
-        auto chunk = new Arena::Chunk {};
+        this->clear();
+    }
+
+    static uint8_t* allocate_chunk_memory(size_t& capacity)
+    {
+        void* memory = nullptr;
+
+#if defined(ENABLE_HUGE_PAGES) && defined(__linux__)
+        // big chunks are backed by huge pages, which saves a lot of tlb misses when scanning large columns.
+        // madvise is only a hint, so it doesn't matter if it fails.
+        if(capacity >= HUGE_PAGE_SIZE)
+        {
+            capacity = (capacity + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+            if(posix_memalign(&memory, HUGE_PAGE_SIZE, capacity) != 0)
+                throw std::bad_alloc();
+
+            madvise(memory, capacity, MADV_HUGEPAGE);
+            return (uint8_t*) memory;
+        }
+#endif
+
+        memory = malloc(capacity);
+        if(memory == nullptr)
+            throw std::bad_alloc();
+
+        return (uint8_t*) memory;
+    }
+
+    static void free_chunk(Arena::Chunk* chunk)
+    {
+        free(chunk->memory);
+        delete chunk;
+    }
+
+    Arena::Chunk* Arena::get_chunk(size_t minimum)
+    {
+        Chunk* chunk = nullptr;
+
+        // take the first free chunk that is big enough; almost all of them are the normal size anyway.
+        for(Chunk** prev = &this->free_list; *prev != nullptr; prev = &(*prev)->next)
+        {
+            if((*prev)->capacity >= minimum)
+            {
+                chunk = *prev;
+                *prev = chunk->next;
+                this->free_bytes -= chunk->capacity;
+                m_stats.chunks_recycled++;
+                break;
+            }
+        }
+
+        if(chunk == nullptr)
+        {
+            chunk = new Arena::Chunk {};
+            chunk->capacity = std::max(minimum, CHUNK_CAPCITY);
+            chunk->memory = allocate_chunk_memory(chunk->capacity);
+            m_stats.chunks_allocated++;
+        }
 
         chunk->used = 0;
         chunk->next = nullptr;
-        chunk->capacity = std::max(minimum, CHUNK_CAPCITY);
-        chunk->memory = (uint8_t*) malloc(chunk->capacity);
 
+        m_stats.num_chunks++;
+        m_stats.peak_num_chunks = std::max(m_stats.peak_num_chunks, m_stats.num_chunks);
         return chunk;
     }
 
+    static void* bump(Arena::Chunk* chunk, size_t req, size_t align, size_t* real_size)
+    {
+        // clang-format off
+        uint8_t* ptr = (uint8_t*) (((uintptr_t) (chunk->memory + chunk->used + (align - 1))) & ~(align - 1));
+        size_t size = (size_t) ((ptr + req) - (chunk->memory + chunk->used));
+        // clang-format on
+
+        if(chunk->used + size > chunk->capacity)
+            return nullptr;
+
+        chunk->used += size;
+        *real_size = size;
+        return ptr;
+    }
+
     void* Arena::allocate(size_t req, size_t align)
     {
         spa_assert((align & (align - 1)) == 0);
 
         if(this->head == nullptr)
+            this->head = this->get_chunk(req + (align - 1));
+
+        if(req == 0)
+            return this->head->memory + this->head->used;
+
+        // only the head chunk is ever bumped; the ones behind it are (more or less) full.
+        size_t real_size = 0;
+        void* ptr = bump(this->head, req, align, &real_size);
+        if(ptr == nullptr)
         {
-            // zpr::fprintln(stderr, "no head");
-            auto chunk = make_new_chunk(req);
-            this->head = chunk;
+            if(req > LARGE_ALLOCATION)
+            {
+                // give it a chunk of its own, behind the head, so the head can keep being used.
+                auto chunk = this->get_chunk(req + (align - 1));
+                chunk->next = this->head->next;
+                this->head->next = chunk;
+                ptr = bump(chunk, req, align, &real_size);
+            }
+            else
+            {
+                auto chunk = this->get_chunk(req + (align - 1));
+                chunk->next = this->head;
+                this->head = chunk;
+                ptr = bump(chunk, req, align, &real_size);
+            }
+
+            spa_assert(ptr != nullptr);
         }
 
-        Chunk* cur = this->head;
-        while(true)
-        {
-            // clang-format off
-            uint8_t* ptr = (uint8_t*) (((uintptr_t) (cur->memory + cur->used + (align - 1))) & ~(align - 1));
-            size_t real_size = (size_t) ((ptr + req) - (cur->memory + cur->used));
-            // clang-format on
+        m_stats.bytes_used += real_size;
+        m_stats.peak_bytes_used = std::max(m_stats.peak_bytes_used, m_stats.bytes_used);
+        return ptr;
+    }
 
-            if(req == 0)
-                return cur->memory + cur->used;
+    void Arena::reset()
+    {
+        auto cur = this->head;
+        while(cur)
+        {
+            auto chunk = cur;
+            cur = cur->next;
 
-            if(cur->used + real_size <= cur->capacity)
+            if(this->free_bytes + chunk->capacity > MAX_RETAINED_BYTES)
             {
-                cur->used += real_size;
-                return ptr;
+                free_chunk(chunk);
             }
-
-            if(cur->next)
+            else
             {
-                cur = cur->next;
-                continue;
+                chunk->next = this->free_list;
+                this->free_list = chunk;
+                this->free_bytes += chunk->capacity;
             }
-
-            size_t worst_case = req + (align - 1);
-            auto chunk = make_new_chunk(worst_case);
-
-            chunk->next = this->head;
-            this->head = chunk;
-            cur = this->head;
         }
+
+        this->head = nullptr;
+        m_stats.bytes_used = 0;
+        m_stats.num_chunks = 0;
     }
 
     void Arena::clear()
     {
         // zpr::fprintln(stderr, "clearing head = {}", (void*) this->head);
+        this->reset();
 
-        auto cur = this->head;
+        auto cur = this->free_list;
         while(cur)
         {
             auto old = cur;
             cur = cur->next;
 
-            free(old->memory);
-            delete old;
+            free_chunk(old);
         }
 
-        this->head = nullptr;
+        this->free_list = nullptr;
+        this->free_bytes = 0;
+    }
+
+    const Arena::Stats& Arena::stats() const
+    {
+        return m_stats;
+    }
+
+    void Arena::resetPeaks()
+    {
+        m_stats.peak_bytes_used = m_stats.bytes_used;
+        m_stats.peak_num_chunks = m_stats.num_chunks;
+        m_stats.chunks_allocated = 0;
+        m_stats.chunks_recycled = 0;
+    }
+
+    ArenaScope::ArenaScope()
+    {
+        if(scope_depth++ == 0)
+            Arena::current().resetPeaks();
+    }
+
+    ArenaScope::~ArenaScope()
+    {
+        if(--scope_depth > 0)
+            return;
+
+        auto& arena = Arena::current();
+
+#ifdef ENABLE_BENCHMARK
+#ifdef BENCHMARK_TO_STDERR
+        const auto& stats = arena.stats();
+        zpr::fprintln(stderr, "arena: peak={}kb; peak chunks={}; allocated chunks={}; recycled chunks={}",
+            stats.peak_bytes_used / 1024.0, stats.peak_num_chunks, stats.chunks_allocated, stats.chunks_recycled);
+#else
+        util::logfmt("ARENA", "peak={}kb; peak chunks={}; allocated chunks={}; recycled chunks={}",
+            arena.stats().peak_bytes_used / 1024.0, arena.stats().peak_num_chunks, arena.stats().chunks_allocated,
+            arena.stats().chunks_recycled);
+#endif
+#endif
+
+        arena.reset();
     }
 }
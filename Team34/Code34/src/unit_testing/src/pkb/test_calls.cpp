@@ -30,18 +30,18 @@ static const Procedure& get_proc(const std::unique_ptr<pkb::ProgramKB>& pkb, con
     return pkb->getProcedureNamed(name);
 }
 
-#define CHECK_CALLS(a, b)                              \
-    do                                                 \
-    {                                                  \
-        CHECK(get_proc(kb, a).callsProcedure(b));      \
-        CHECK(get_proc(kb, b).isCalledByProcedure(a)); \
+#define CHECK_CALLS(a, b)                                                    \
+    do                                                                       \
+    {                                                                        \
+        CHECK(get_proc(kb, a).callsProcedure(get_proc(kb, b).getId()));      \
+        CHECK(get_proc(kb, b).isCalledByProcedure(get_proc(kb, a).getId())); \
     } while(0)
 
-#define CHECK_NOT_CALLS(a, b)                                \
-    do                                                       \
-    {                                                        \
-        CHECK_FALSE(get_proc(kb, a).callsProcedure(b));      \
-        CHECK_FALSE(get_proc(kb, b).isCalledByProcedure(a)); \
+#define CHECK_NOT_CALLS(a, b)                                                      \
+    do                                                                             \
+    {                                                                              \
+        CHECK_FALSE(get_proc(kb, a).callsProcedure(get_proc(kb, b).getId()));      \
+        CHECK_FALSE(get_proc(kb, b).isCalledByProcedure(get_proc(kb, a).getId())); \
     } while(0)
 
 
@@ -78,18 +78,18 @@ TEST_CASE("Calls(a, b)")
     }
 }
 
-#define CHECK_CALLS_STAR(a, b)                                     \
-    do                                                             \
-    {                                                              \
-        CHECK(get_proc(kb, a).callsProcedureTransitively(b));      \
-        CHECK(get_proc(kb, b).isTransitivelyCalledByProcedure(a)); \
+#define CHECK_CALLS_STAR(a, b)                                                           \
+    do                                                                                   \
+    {                                                                                    \
+        CHECK(get_proc(kb, a).callsProcedureTransitively(get_proc(kb, b).getId()));      \
+        CHECK(get_proc(kb, b).isTransitivelyCalledByProcedure(get_proc(kb, a).getId())); \
     } while(0)
 
-#define CHECK_NOT_CALLS_STAR(a, b)                                       \
-    do                                                                   \
-    {                                                                    \
-        CHECK_FALSE(get_proc(kb, a).callsProcedureTransitively(b));      \
-        CHECK_FALSE(get_proc(kb, b).isTransitivelyCalledByProcedure(a)); \
+#define CHECK_NOT_CALLS_STAR(a, b)                                                             \
+    do                                                                                         \
+    {                                                                                          \
+        CHECK_FALSE(get_proc(kb, a).callsProcedureTransitively(get_proc(kb, b).getId()));      \
+        CHECK_FALSE(get_proc(kb, b).isTransitivelyCalledByProcedure(get_proc(kb, a).getId())); \
     } while(0)
 
 TEST_CASE("Calls*(a, b)")
@@ -402,6 +402,58 @@ TEST_CASE("Next*(a,b)")
     }
 }
 
+// a transitive relation should be exactly the set of statements found by walking the relation from a statement.
+// `step`, `closure` and `inverse_closure` return the statements related to one statement, and `holds` checks a pair.
+template <typename Step, typename Closure, typename Holds, typename InverseClosure>
+static void check_closure_against_traversal(
+    const ProgramKB* kb, Step step, Closure closure, Holds holds, InverseClosure inverse_closure)
+{
+    auto total = kb->getAllStatements().size();
+    for(StatementNum a = 1; a <= total; a++)
+    {
+        StatementSet seen {};
+        std::vector<StatementNum> worklist {};
+        for(auto s : step(a))
+            worklist.push_back(s);
+
+        while(!worklist.empty())
+        {
+            auto s = worklist.back();
+            worklist.pop_back();
+            if(!seen.insert(s).second)
+                continue;
+
+            for(auto next : step(s))
+                worklist.push_back(next);
+        }
+
+        CHECK(closure(a) == seen);
+        for(StatementNum b = 1; b <= total; b++)
+        {
+            CHECK(holds(a, b) == (seen.count(b) > 0));
+            CHECK(inverse_closure(b).count(a) == seen.count(b));
+        }
+    }
+}
+
+static void check_next_closure_against_traversal(const ProgramKB* kb)
+{
+    auto cfg = kb->getCFG();
+    check_closure_against_traversal(
+        kb, [cfg](StatementNum s) { return cfg->getNextStatements(s); },
+        [cfg](StatementNum s) { return cfg->getTransitivelyNextStatements(s); },
+        [cfg](StatementNum a, StatementNum b) { return cfg->isStatementTransitivelyNext(a, b); },
+        [cfg](StatementNum s) { return cfg->getTransitivelyPreviousStatements(s); });
+}
+
+TEST_CASE("Next*(a,b) matches traversal")
+{
+    check_next_closure_against_traversal(kb1.get());
+    check_next_closure_against_traversal(kb2.get());
+    check_next_closure_against_traversal(kb3.get());
+    check_next_closure_against_traversal(kb4.get());
+}
+
 TEST_CASE("Affects(a,b)")
 {
     SECTION("Straightforward")
@@ -451,6 +503,16 @@ TEST_CASE("Affects(a,b)")
         CHECK(!cfg2->doesAffect(14, 16));
     }
 
+    SECTION("All affected and affecting statements")
+    {
+        CHECK(cfg4->getAffectedStatements(4) == StatementSet { 4, 8, 10 });
+        CHECK(cfg4->getAffectingStatements(4) == StatementSet { 1, 4 });
+        CHECK(cfg4->getAffectingStatements(10) == StatementSet { 1, 2, 4, 6, 8, 9 });
+        CHECK(cfg4->getAffectedStatements(14).empty());
+        CHECK(cfg4->getAffectedStatements(3).empty());
+        CHECK(cfg4->getAffectingStatements(7).empty());
+    }
+
     SECTION("Negative test case: Next*(a, b) doesn't hold")
     {
         CHECK(!cfg1->doesAffect(5, 5));
@@ -495,3 +557,21 @@ TEST_CASE("Affects*(a,b)")
         CHECK(!cfg4->doesTransitivelyAffect(8, 9));
     }
 }
+
+static void check_affects_closure_against_traversal(const ProgramKB* kb)
+{
+    auto cfg = kb->getCFG();
+    check_closure_against_traversal(
+        kb, [cfg](StatementNum s) { return cfg->getAffectedStatements(s); },
+        [cfg](StatementNum s) { return cfg->getTransitivelyAffectedStatements(s); },
+        [cfg](StatementNum a, StatementNum b) { return cfg->doesTransitivelyAffect(a, b); },
+        [cfg](StatementNum s) { return cfg->getTransitivelyAffectingStatements(s); });
+}
+
+TEST_CASE("Affects*(a,b) matches traversal")
+{
+    check_affects_closure_against_traversal(kb1.get());
+    check_affects_closure_against_traversal(kb2.get());
+    check_affects_closure_against_traversal(kb3.get());
+    check_affects_closure_against_traversal(kb4.get());
+}
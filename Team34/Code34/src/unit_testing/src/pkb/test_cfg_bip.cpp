@@ -64,6 +64,27 @@ procedure Q3 {
       a = a;}
 )";
 
+// callees that return from a while loop, at the end of the procedure and at the end of an if
+constexpr const auto sample_source_D = R"(
+procedure main {
+      x = 1;
+      call p;
+      y = x;
+      call q;
+      z = x; }
+
+procedure p {
+      while (z > 0) {
+              z = z - 1; } }
+
+procedure q {
+      if (a > 0) then {
+              while (b > 0) {
+                      b = b - 1; } }
+      else {
+              a = a; } }
+)";
+
 static auto kb1 = DesignExtractor(parseProgram(sample_source_A)).run();
 static auto cfg1 = kb1 -> getCFG();
 
@@ -73,6 +94,9 @@ static auto cfg2 = kb2 -> getCFG();
 static auto kb3 = DesignExtractor(parseProgram(sample_source_C)).run();
 static auto cfg3 = kb3 -> getCFG();
 
+static auto kb4 = DesignExtractor(parseProgram(sample_source_D)).run();
+static auto cfg4 = kb4 -> getCFG();
+
 TEST_CASE("NextBip and NextBip*")
 {
     SECTION("positive test cases: bip")
@@ -118,6 +142,14 @@ TEST_CASE("NextBip and NextBip*")
         CHECK(cfg1->getTransitivelyNextStatementsBip(11) == StatementSet { 3, 4, 5, 8, 9, 10, 11 });
         CHECK(cfg1->getTransitivelyPreviousStatementsBip(8) == StatementSet { 1, 2, 6, 7, 9, 10, 11 });
     }
+    SECTION("unbalanced calls and returns")
+    {
+        CHECK(cfg2->getTransitivelyNextStatementsBip(4) == StatementSet { 2, 3, 4, 5, 6, 7 });
+        CHECK(cfg2->getTransitivelyPreviousStatementsBip(4) == StatementSet { 1, 2, 3, 4, 5, 6, 7 });
+        CHECK(cfg2->getTransitivelyPreviousStatementsBip(1).empty());
+        CHECK(cfg3->getTransitivelyNextStatementsBip(9) == StatementSet { 2, 3, 4, 5, 6, 7, 8, 9 });
+        CHECK(!cfg3->isStatementTransitivelyNextBip(9, 1));
+    }
 }
 
 TEST_CASE("AffectsBip(a, b)")
@@ -193,4 +225,28 @@ TEST_CASE("AffectsBip*(a, b)")
     {
         CHECK(!cfg2->doesTransitivelyAffectBip(7, 4));
     }
+
+    SECTION("all affected and affecting statements")
+    {
+        CHECK(cfg2->getAffectedStatementsBip(7) == StatementSet { 6 });
+        CHECK(cfg2->getTransitivelyAffectedStatementsBip(7) == StatementSet { 5, 6 });
+        CHECK(cfg2->getTransitivelyAffectedStatementsBip(4) == StatementSet { 5, 6, 7 });
+        CHECK(cfg2->getTransitivelyAffectingStatementsBip(4) == StatementSet { 5, 6 });
+        CHECK(cfg1->getAffectingStatementsBip(8) == StatementSet { 1, 6, 10, 11 });
+        CHECK(cfg1->getAffectedStatementsBip(7).empty());
+    }
+}
+
+TEST_CASE("AffectsBip through a callee that ends in a while")
+{
+    CHECK(cfg4->doesAffectBip(1, 3));
+    CHECK(cfg4->doesAffectBip(1, 5));
+    CHECK(cfg4->doesTransitivelyAffectBip(1, 3));
+    CHECK(cfg4->doesTransitivelyAffectBip(1, 5));
+    CHECK(cfg4->getAffectedStatementsBip(1) == StatementSet { 3, 5 });
+    CHECK(cfg4->getAffectingStatementsBip(5) == StatementSet { 1 });
+
+    // the loops themselves are unaffected by the fix
+    CHECK(cfg4->getAffectedStatementsBip(7) == StatementSet { 7 });
+    CHECK(cfg4->getAffectedStatementsBip(10) == StatementSet { 10 });
 }
@@ -101,71 +101,92 @@ static const Variable& get_var(const std::unique_ptr<pkb::ProgramKB>& pkb, const
     return pkb->getVariableNamed(name);
 }
 
+static VarId var_id(const std::unique_ptr<pkb::ProgramKB>& pkb, const char* name)
+{
+    return pkb->getVariableNamed(name).getId();
+}
+
+static std::unordered_set<std::string> var_names(const std::unique_ptr<pkb::ProgramKB>& pkb, const VarIdSet& ids)
+{
+    std::unordered_set<std::string> ret {};
+    for(auto id : ids)
+        ret.insert(pkb->getVariableWithId(id).getName());
+    return ret;
+}
+
+static std::unordered_set<std::string> proc_names(const std::unique_ptr<pkb::ProgramKB>& pkb, const ProcIdSet& ids)
+{
+    std::unordered_set<std::string> ret {};
+    for(auto id : ids)
+        ret.insert(pkb->getProcedureWithId(id).getName());
+    return ret;
+}
+
 
 TEST_CASE("Modifies(DeclaredStmt, DeclaredVar)")
 {
     SECTION("Modifies(DeclaredStmt, DeclaredVar) for assignment, condition and read")
     {
-        CHECK(get_stmt(kb_sample, 1).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 5).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 8).modifiesVariable("y"));
-        CHECK(get_stmt(kb_sample, 9).modifiesVariable("z"));
-
-        CHECK(get_stmt(kb_trivial, 4).modifiesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 5).modifiesVariable("y"));
-        CHECK(get_stmt(kb_trivial, 15).modifiesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 20).modifiesVariable("flag"));
-        CHECK(get_stmt(kb_trivial, 21).modifiesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 23).modifiesVariable("normSq"));
+        CHECK(get_stmt(kb_sample, 1).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 5).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 8).modifiesVariable(var_id(kb_sample, "y")));
+        CHECK(get_stmt(kb_sample, 9).modifiesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_stmt(kb_trivial, 4).modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 5).modifiesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_stmt(kb_trivial, 15).modifiesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 20).modifiesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_stmt(kb_trivial, 21).modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 23).modifiesVariable(var_id(kb_trivial, "normSq")));
     }
 
     SECTION("Modifies(DeclaredStmt, DeclaredVar) inside if/while")
     {
-        CHECK(get_stmt(kb_sample, 4).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 4).modifiesVariable("y"));
-        CHECK(get_stmt(kb_sample, 4).modifiesVariable("z"));
-        CHECK(get_stmt(kb_sample, 6).modifiesVariable("y"));
-        CHECK(get_stmt(kb_sample, 6).modifiesVariable("z"));
-        CHECK(get_stmt(kb_sample, 13).modifiesVariable("i"));
-        CHECK(get_stmt(kb_sample, 13).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 13).modifiesVariable("z"));
-
-        CHECK(get_stmt(kb_trivial, 14).modifiesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 14).modifiesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 14).modifiesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 19).modifiesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 19).modifiesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 19).modifiesVariable("flag"));
+        CHECK(get_stmt(kb_sample, 4).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 4).modifiesVariable(var_id(kb_sample, "y")));
+        CHECK(get_stmt(kb_sample, 4).modifiesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 6).modifiesVariable(var_id(kb_sample, "y")));
+        CHECK(get_stmt(kb_sample, 6).modifiesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 13).modifiesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 13).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 13).modifiesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_stmt(kb_trivial, 14).modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 14).modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 14).modifiesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 19).modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 19).modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 19).modifiesVariable(var_id(kb_trivial, "flag")));
     }
 
     SECTION("Modifies(DeclaredStmt, DeclaredVar) for procCall")
     {
-        CHECK(get_stmt(kb_sample, 10).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 10).modifiesVariable("z"));
-        CHECK(get_stmt(kb_sample, 12).modifiesVariable("i"));
-        CHECK(get_stmt(kb_sample, 12).modifiesVariable("x"));
-        CHECK(get_stmt(kb_sample, 12).modifiesVariable("z"));
-
-        CHECK(get_stmt(kb_trivial, 2).modifiesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 2).modifiesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 2).modifiesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 2).modifiesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 2).modifiesVariable("y"));
-        CHECK(get_stmt(kb_trivial, 18).modifiesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 18).modifiesVariable("y"));
+        CHECK(get_stmt(kb_sample, 10).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 10).modifiesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 12).modifiesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 12).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 12).modifiesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_stmt(kb_trivial, 2).modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 2).modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 2).modifiesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 2).modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 2).modifiesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_stmt(kb_trivial, 18).modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 18).modifiesVariable(var_id(kb_trivial, "y")));
     }
 
     SECTION("Modifies(DeclaredStmt, DeclaredVar) negative test cases")
     {
-        CHECK_FALSE(get_stmt(kb_sample, 6).modifiesVariable("x"));
-        CHECK_FALSE(get_stmt(kb_sample, 7).modifiesVariable("x"));
-        CHECK_FALSE(get_stmt(kb_sample, 15).modifiesVariable("z"));
-        CHECK_FALSE(get_stmt(kb_sample, 16).modifiesVariable("i"));
-
-        CHECK_FALSE(get_stmt(kb_trivial, 6).modifiesVariable("flag"));
-        CHECK_FALSE(get_stmt(kb_trivial, 14).modifiesVariable("flag"));
-        CHECK_FALSE(get_stmt(kb_trivial, 23).modifiesVariable("cenX"));
-        CHECK_FALSE(get_stmt(kb_trivial, 23).modifiesVariable("cenY"));
+        CHECK_FALSE(get_stmt(kb_sample, 6).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK_FALSE(get_stmt(kb_sample, 7).modifiesVariable(var_id(kb_sample, "x")));
+        CHECK_FALSE(get_stmt(kb_sample, 15).modifiesVariable(var_id(kb_sample, "z")));
+        CHECK_FALSE(get_stmt(kb_sample, 16).modifiesVariable(var_id(kb_sample, "i")));
+
+        CHECK_FALSE(get_stmt(kb_trivial, 6).modifiesVariable(var_id(kb_trivial, "flag")));
+        CHECK_FALSE(get_stmt(kb_trivial, 14).modifiesVariable(var_id(kb_trivial, "flag")));
+        CHECK_FALSE(get_stmt(kb_trivial, 23).modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK_FALSE(get_stmt(kb_trivial, 23).modifiesVariable(var_id(kb_trivial, "cenY")));
     }
 }
 
@@ -173,45 +194,45 @@ TEST_CASE("Modifies(DeclaredProc, DeclaredVar)")
 {
     SECTION("Modifies(DeclaredProc, DeclaredVar)")
     {
-        CHECK(get_proc(kb_sample, "Example").modifiesVariable("i"));
-        CHECK(get_proc(kb_sample, "Example").modifiesVariable("x"));
-        CHECK(get_proc(kb_sample, "Example").modifiesVariable("y"));
-        CHECK(get_proc(kb_sample, "Example").modifiesVariable("z"));
-        CHECK(get_proc(kb_sample, "p").modifiesVariable("i"));
-        CHECK(get_proc(kb_sample, "p").modifiesVariable("x"));
-        CHECK(get_proc(kb_sample, "p").modifiesVariable("z"));
-        CHECK(get_proc(kb_sample, "q").modifiesVariable("x"));
-        CHECK(get_proc(kb_sample, "q").modifiesVariable("z"));
-
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("cenX"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("cenY"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("count"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("flag"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("normSq"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("x"));
-        CHECK(get_proc(kb_trivial, "main").modifiesVariable("y"));
-        CHECK(get_proc(kb_trivial, "readPoint").modifiesVariable("x"));
-        CHECK(get_proc(kb_trivial, "readPoint").modifiesVariable("y"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("cenX"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("cenY"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("count"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("flag"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("normSq"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("x"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable("y"));
+        CHECK(get_proc(kb_sample, "Example").modifiesVariable(var_id(kb_sample, "i")));
+        CHECK(get_proc(kb_sample, "Example").modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "Example").modifiesVariable(var_id(kb_sample, "y")));
+        CHECK(get_proc(kb_sample, "Example").modifiesVariable(var_id(kb_sample, "z")));
+        CHECK(get_proc(kb_sample, "p").modifiesVariable(var_id(kb_sample, "i")));
+        CHECK(get_proc(kb_sample, "p").modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "p").modifiesVariable(var_id(kb_sample, "z")));
+        CHECK(get_proc(kb_sample, "q").modifiesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "q").modifiesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "normSq")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_proc(kb_trivial, "main").modifiesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_proc(kb_trivial, "readPoint").modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_proc(kb_trivial, "readPoint").modifiesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "normSq")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").modifiesVariable(var_id(kb_trivial, "y")));
     }
 
     SECTION("Modifies(DeclaredProc, DeclaredVar) negative test cases")
     {
-        CHECK_FALSE(get_proc(kb_sample, "p").modifiesVariable("y"));
-        CHECK_FALSE(get_proc(kb_sample, "q").modifiesVariable("y"));
-        CHECK_FALSE(get_proc(kb_sample, "q").modifiesVariable("i"));
+        CHECK_FALSE(get_proc(kb_sample, "p").modifiesVariable(var_id(kb_sample, "y")));
+        CHECK_FALSE(get_proc(kb_sample, "q").modifiesVariable(var_id(kb_sample, "y")));
+        CHECK_FALSE(get_proc(kb_sample, "q").modifiesVariable(var_id(kb_sample, "i")));
 
 
-        CHECK_FALSE(get_proc(kb_trivial, "readPoint").modifiesVariable("cenX"));
-        CHECK_FALSE(get_proc(kb_trivial, "readPoint").modifiesVariable("cenY"));
-        CHECK_FALSE(get_proc(kb_trivial, "printResults").modifiesVariable("cenX"));
-        CHECK_FALSE(get_proc(kb_trivial, "printResults").modifiesVariable("cenY"));
+        CHECK_FALSE(get_proc(kb_trivial, "readPoint").modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK_FALSE(get_proc(kb_trivial, "readPoint").modifiesVariable(var_id(kb_trivial, "cenY")));
+        CHECK_FALSE(get_proc(kb_trivial, "printResults").modifiesVariable(var_id(kb_trivial, "cenX")));
+        CHECK_FALSE(get_proc(kb_trivial, "printResults").modifiesVariable(var_id(kb_trivial, "cenY")));
     }
 }
 
@@ -219,25 +240,25 @@ TEST_CASE("Modifies(DeclaredStmt, AllVar)")
 {
     SECTION("Modifies(DeclaredStmt, AllVar) for assignment and read")
     {
-        auto& fst_result = get_stmt(kb_sample, 1).getModifiedVariables();
+        auto fst_result = var_names(kb_sample, get_stmt(kb_sample, 1).getModifiedVariableIds());
         CHECK(fst_result.size() == 1);
         CHECK(fst_result.count("x"));
 
-        auto& snd_result = get_stmt(kb_trivial, 4).getModifiedVariables();
+        auto snd_result = var_names(kb_trivial, get_stmt(kb_trivial, 4).getModifiedVariableIds());
         CHECK(snd_result.size() == 1);
         CHECK(snd_result.count("x"));
     }
 
     SECTION("Modifies(DeclaredStmt, AllVar) inside if/while")
     {
-        auto& fst_result = get_stmt(kb_sample, 4).getModifiedVariables();
+        auto fst_result = var_names(kb_sample, get_stmt(kb_sample, 4).getModifiedVariableIds());
         CHECK(fst_result.size() == 4);
         CHECK(fst_result.count("i"));
         CHECK(fst_result.count("x"));
         CHECK(fst_result.count("y"));
         CHECK(fst_result.count("z"));
 
-        auto& snd_result = get_stmt(kb_sample, 6).getModifiedVariables();
+        auto snd_result = var_names(kb_sample, get_stmt(kb_sample, 6).getModifiedVariableIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("y"));
         CHECK(snd_result.count("z"));
@@ -245,7 +266,7 @@ TEST_CASE("Modifies(DeclaredStmt, AllVar)")
 
     SECTION("Modifies(DeclaredStmt, AllVar) for procCalls")
     {
-        auto& fst_result = get_stmt(kb_trivial, 2).getModifiedVariables();
+        auto fst_result = var_names(kb_trivial, get_stmt(kb_trivial, 2).getModifiedVariableIds());
         CHECK(fst_result.size() == 7);
         CHECK(fst_result.count("cenX"));
         CHECK(fst_result.count("cenY"));
@@ -255,12 +276,12 @@ TEST_CASE("Modifies(DeclaredStmt, AllVar)")
         CHECK(fst_result.count("x"));
         CHECK(fst_result.count("y"));
 
-        auto& snd_result = get_stmt(kb_sample, 10).getModifiedVariables();
+        auto snd_result = var_names(kb_sample, get_stmt(kb_sample, 10).getModifiedVariableIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("x"));
         CHECK(snd_result.count("z"));
 
-        auto& trd_result = get_stmt(kb_trivial, 18).getModifiedVariables();
+        auto trd_result = var_names(kb_trivial, get_stmt(kb_trivial, 18).getModifiedVariableIds());
         CHECK(trd_result.size() == 2);
         CHECK(trd_result.count("x"));
         CHECK(trd_result.count("y"));
@@ -271,7 +292,7 @@ TEST_CASE("Modifies(DeclaredProc, AllVar)")
 {
     SECTION("Modifies(DeclaredProc, AllVar) for assignment and print")
     {
-        auto& fst_result = get_proc(kb_trivial, "main").getModifiedVariables();
+        auto fst_result = var_names(kb_trivial, get_proc(kb_trivial, "main").getModifiedVariableIds());
         CHECK(fst_result.size() == 7);
         CHECK(fst_result.count("cenX"));
         CHECK(fst_result.count("cenY"));
@@ -281,12 +302,12 @@ TEST_CASE("Modifies(DeclaredProc, AllVar)")
         CHECK(fst_result.count("x"));
         CHECK(fst_result.count("y"));
 
-        auto& snd_result = get_proc(kb_trivial, "readPoint").getModifiedVariables();
+        auto snd_result = var_names(kb_trivial, get_proc(kb_trivial, "readPoint").getModifiedVariableIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("x"));
         CHECK(snd_result.count("y"));
 
-        auto& trd_result = get_proc(kb_trivial, "computeCentroid").getModifiedVariables();
+        auto trd_result = var_names(kb_trivial, get_proc(kb_trivial, "computeCentroid").getModifiedVariableIds());
         CHECK(trd_result.size() == 7);
         CHECK(trd_result.count("cenX"));
         CHECK(trd_result.count("cenY"));
@@ -296,7 +317,7 @@ TEST_CASE("Modifies(DeclaredProc, AllVar)")
         CHECK(trd_result.count("x"));
         CHECK(trd_result.count("y"));
 
-        auto& frh_result = get_proc(kb_trivial, "printResults").getModifiedVariables();
+        auto frh_result = var_names(kb_trivial, get_proc(kb_trivial, "printResults").getModifiedVariableIds());
         CHECK(frh_result.size() == 0);
     }
 }
@@ -393,16 +414,16 @@ TEST_CASE("Modifies(Synonym, DeclaredVar)")
 
     SECTION("Uses(PROCEDURE, DeclaredVar)")
     {
-        auto fst_result = get_var(kb_sample, "y").getModifyingProcNames();
+        auto fst_result = proc_names(kb_sample, get_var(kb_sample, "y").getModifyingProcIds());
         CHECK(fst_result.size() == 1);
         CHECK(fst_result.count("Example"));
 
-        auto snd_result = get_var(kb_trivial, "flag").getModifyingProcNames();
+        auto snd_result = proc_names(kb_trivial, get_var(kb_trivial, "flag").getModifyingProcIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("computeCentroid"));
         CHECK(snd_result.count("main"));
 
-        auto trd_result = get_var(kb_trivial, "x").getModifyingProcNames();
+        auto trd_result = proc_names(kb_trivial, get_var(kb_trivial, "x").getModifyingProcIds());
         CHECK(trd_result.size() == 3);
         CHECK(trd_result.count("computeCentroid"));
         CHECK(trd_result.count("main"));
@@ -101,80 +101,101 @@ static const Variable& get_var(const std::unique_ptr<pkb::ProgramKB>& pkb, const
     return pkb->getVariableNamed(name);
 }
 
+static VarId var_id(const std::unique_ptr<pkb::ProgramKB>& pkb, const char* name)
+{
+    return pkb->getVariableNamed(name).getId();
+}
+
+static std::unordered_set<std::string> var_names(const std::unique_ptr<pkb::ProgramKB>& pkb, const VarIdSet& ids)
+{
+    std::unordered_set<std::string> ret {};
+    for(auto id : ids)
+        ret.insert(pkb->getVariableWithId(id).getName());
+    return ret;
+}
+
+static std::unordered_set<std::string> proc_names(const std::unique_ptr<pkb::ProgramKB>& pkb, const ProcIdSet& ids)
+{
+    std::unordered_set<std::string> ret {};
+    for(auto id : ids)
+        ret.insert(pkb->getProcedureWithId(id).getName());
+    return ret;
+}
+
 TEST_CASE("Uses(DeclaredStmt, DeclaredVar)")
 {
     SECTION("Uses(DeclaredStmt, DeclaredVar) for assignment, condition and print")
     {
-        CHECK(get_stmt(kb_sample, 4).usesVariable("i"));
-        CHECK(get_stmt(kb_sample, 6).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 9).usesVariable("i"));
-        CHECK(get_stmt(kb_sample, 9).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 9).usesVariable("z"));
-        CHECK(get_stmt(kb_sample, 13).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 14).usesVariable("i"));
-
-        CHECK(get_stmt(kb_trivial, 6).usesVariable("flag"));
-        CHECK(get_stmt(kb_trivial, 9).usesVariable("normSq"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("y"));
-        CHECK(get_stmt(kb_trivial, 19).usesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 23).usesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 23).usesVariable("cenY"));
+        CHECK(get_stmt(kb_sample, 4).usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 6).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 9).usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 9).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 9).usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 13).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 14).usesVariable(var_id(kb_sample, "i")));
+
+        CHECK(get_stmt(kb_trivial, 6).usesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_stmt(kb_trivial, 9).usesVariable(var_id(kb_trivial, "normSq")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_stmt(kb_trivial, 19).usesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 23).usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 23).usesVariable(var_id(kb_trivial, "cenY")));
     }
 
     SECTION("Uses(DeclaredStmt, DeclaredVar) inside if/while")
     {
-        CHECK(get_stmt(kb_sample, 4).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 4).usesVariable("z"));
-        CHECK(get_stmt(kb_sample, 6).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 6).usesVariable("z"));
-        CHECK(get_stmt(kb_sample, 13).usesVariable("i"));
-        CHECK(get_stmt(kb_sample, 13).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 13).usesVariable("y"));
-        CHECK(get_stmt(kb_sample, 13).usesVariable("z"));
-
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 14).usesVariable("y"));
-        CHECK(get_stmt(kb_trivial, 19).usesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 19).usesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 19).usesVariable("count"));
+        CHECK(get_stmt(kb_sample, 4).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 4).usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 6).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 6).usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 13).usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 13).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 13).usesVariable(var_id(kb_sample, "y")));
+        CHECK(get_stmt(kb_sample, 13).usesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_stmt(kb_trivial, 19).usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 19).usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 19).usesVariable(var_id(kb_trivial, "count")));
     }
 
     SECTION("Uses(DeclaredStmt, DeclaredVar) for procCall")
     {
-        CHECK(get_stmt(kb_sample, 10).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 10).usesVariable("z"));
-        CHECK(get_stmt(kb_sample, 12).usesVariable("i"));
-        CHECK(get_stmt(kb_sample, 12).usesVariable("x"));
-        CHECK(get_stmt(kb_sample, 12).usesVariable("y"));
-        CHECK(get_stmt(kb_sample, 12).usesVariable("z"));
-
-        CHECK(get_stmt(kb_trivial, 2).usesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 2).usesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 2).usesVariable("count"));
-        CHECK(get_stmt(kb_trivial, 2).usesVariable("x"));
-        CHECK(get_stmt(kb_trivial, 2).usesVariable("y"));
-        CHECK(get_stmt(kb_trivial, 3).usesVariable("cenX"));
-        CHECK(get_stmt(kb_trivial, 3).usesVariable("cenY"));
-        CHECK(get_stmt(kb_trivial, 3).usesVariable("flag"));
-        CHECK(get_stmt(kb_trivial, 3).usesVariable("normSq"));
+        CHECK(get_stmt(kb_sample, 10).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 10).usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_stmt(kb_sample, 12).usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_stmt(kb_sample, 12).usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_stmt(kb_sample, 12).usesVariable(var_id(kb_sample, "y")));
+        CHECK(get_stmt(kb_sample, 12).usesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_stmt(kb_trivial, 2).usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 2).usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 2).usesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_stmt(kb_trivial, 2).usesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_stmt(kb_trivial, 2).usesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_stmt(kb_trivial, 3).usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_stmt(kb_trivial, 3).usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_stmt(kb_trivial, 3).usesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_stmt(kb_trivial, 3).usesVariable(var_id(kb_trivial, "normSq")));
     }
 
     SECTION("Uses(DeclaredStmt, DeclaredVar) negative test cases")
     {
-        CHECK_FALSE(get_stmt(kb_sample, 3).usesVariable("i"));
-        CHECK_FALSE(get_stmt(kb_sample, 6).usesVariable("y"));
-        CHECK_FALSE(get_stmt(kb_sample, 7).usesVariable("z"));
-        CHECK_FALSE(get_stmt(kb_sample, 10).usesVariable("i"));
+        CHECK_FALSE(get_stmt(kb_sample, 3).usesVariable(var_id(kb_sample, "i")));
+        CHECK_FALSE(get_stmt(kb_sample, 6).usesVariable(var_id(kb_sample, "y")));
+        CHECK_FALSE(get_stmt(kb_sample, 7).usesVariable(var_id(kb_sample, "z")));
+        CHECK_FALSE(get_stmt(kb_sample, 10).usesVariable(var_id(kb_sample, "i")));
 
 
-        CHECK_FALSE(get_stmt(kb_trivial, 1).usesVariable("flag"));
-        CHECK_FALSE(get_stmt(kb_trivial, 14).usesVariable("flag"));
-        CHECK_FALSE(get_stmt(kb_trivial, 18).usesVariable("x"));
-        CHECK_FALSE(get_stmt(kb_trivial, 18).usesVariable("y"));
+        CHECK_FALSE(get_stmt(kb_trivial, 1).usesVariable(var_id(kb_trivial, "flag")));
+        CHECK_FALSE(get_stmt(kb_trivial, 14).usesVariable(var_id(kb_trivial, "flag")));
+        CHECK_FALSE(get_stmt(kb_trivial, 18).usesVariable(var_id(kb_trivial, "x")));
+        CHECK_FALSE(get_stmt(kb_trivial, 18).usesVariable(var_id(kb_trivial, "y")));
     }
 }
 
@@ -182,45 +203,45 @@ TEST_CASE("Uses(DeclaredProc, DeclaredVar)")
 {
     SECTION("Uses(DeclaredProc, DeclaredVar)")
     {
-        CHECK(get_proc(kb_sample, "Example").usesVariable("i"));
-        CHECK(get_proc(kb_sample, "Example").usesVariable("x"));
-        CHECK(get_proc(kb_sample, "Example").usesVariable("y"));
-        CHECK(get_proc(kb_sample, "Example").usesVariable("z"));
-        CHECK(get_proc(kb_sample, "p").usesVariable("i"));
-        CHECK(get_proc(kb_sample, "p").usesVariable("x"));
-        CHECK(get_proc(kb_sample, "p").usesVariable("y"));
-        CHECK(get_proc(kb_sample, "p").usesVariable("z"));
-        CHECK(get_proc(kb_sample, "q").usesVariable("x"));
-        CHECK(get_proc(kb_sample, "q").usesVariable("z"));
-
-        CHECK(get_proc(kb_trivial, "main").usesVariable("cenX"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("cenY"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("count"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("flag"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("normSq"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("x"));
-        CHECK(get_proc(kb_trivial, "main").usesVariable("y"));
-        CHECK(get_proc(kb_trivial, "printResults").usesVariable("cenX"));
-        CHECK(get_proc(kb_trivial, "printResults").usesVariable("cenY"));
-        CHECK(get_proc(kb_trivial, "printResults").usesVariable("flag"));
-        CHECK(get_proc(kb_trivial, "printResults").usesVariable("normSq"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable("cenX"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable("cenY"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable("count"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable("x"));
-        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable("y"));
+        CHECK(get_proc(kb_sample, "Example").usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_proc(kb_sample, "Example").usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "Example").usesVariable(var_id(kb_sample, "y")));
+        CHECK(get_proc(kb_sample, "Example").usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_proc(kb_sample, "p").usesVariable(var_id(kb_sample, "i")));
+        CHECK(get_proc(kb_sample, "p").usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "p").usesVariable(var_id(kb_sample, "y")));
+        CHECK(get_proc(kb_sample, "p").usesVariable(var_id(kb_sample, "z")));
+        CHECK(get_proc(kb_sample, "q").usesVariable(var_id(kb_sample, "x")));
+        CHECK(get_proc(kb_sample, "q").usesVariable(var_id(kb_sample, "z")));
+
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "normSq")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_proc(kb_trivial, "main").usesVariable(var_id(kb_trivial, "y")));
+        CHECK(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "flag")));
+        CHECK(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "normSq")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "cenX")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "cenY")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "count")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "x")));
+        CHECK(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "y")));
     }
 
     SECTION("Uses(DeclaredProc, DeclaredVar) negative test cases")
     {
-        CHECK_FALSE(get_proc(kb_sample, "q").usesVariable("y"));
-        CHECK_FALSE(get_proc(kb_sample, "q").usesVariable("i"));
+        CHECK_FALSE(get_proc(kb_sample, "q").usesVariable(var_id(kb_sample, "y")));
+        CHECK_FALSE(get_proc(kb_sample, "q").usesVariable(var_id(kb_sample, "i")));
 
 
-        CHECK_FALSE(get_proc(kb_trivial, "printResults").usesVariable("x"));
-        CHECK_FALSE(get_proc(kb_trivial, "printResults").usesVariable("y"));
-        CHECK_FALSE(get_proc(kb_trivial, "computeCentroid").usesVariable("flag"));
-        CHECK_FALSE(get_proc(kb_trivial, "computeCentroid").usesVariable("normSq"));
+        CHECK_FALSE(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "x")));
+        CHECK_FALSE(get_proc(kb_trivial, "printResults").usesVariable(var_id(kb_trivial, "y")));
+        CHECK_FALSE(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "flag")));
+        CHECK_FALSE(get_proc(kb_trivial, "computeCentroid").usesVariable(var_id(kb_trivial, "normSq")));
     }
 }
 
@@ -228,26 +249,26 @@ TEST_CASE("Uses(DeclaredStmt, AllVar)")
 {
     SECTION("Uses(DeclaredStmt, AllVar) for assignment and print")
     {
-        auto& fst_result = get_stmt(kb_sample, 1).getUsedVariables();
+        auto fst_result = var_names(kb_sample, get_stmt(kb_sample, 1).getUsedVariableIds());
         CHECK(fst_result.size() == 0);
 
-        auto& snd_result = get_stmt(kb_sample, 5).getUsedVariables();
+        auto snd_result = var_names(kb_sample, get_stmt(kb_sample, 5).getUsedVariableIds());
         CHECK(snd_result.size() == 1);
         CHECK(snd_result.count("x"));
 
-        auto& trd_result = get_stmt(kb_trivial, 6).getUsedVariables();
+        auto trd_result = var_names(kb_trivial, get_stmt(kb_trivial, 6).getUsedVariableIds());
         CHECK(trd_result.size() == 1);
         CHECK(trd_result.count("flag"));
     }
 
     SECTION("Uses(DeclaredStmt, AllVar) inside if/while")
     {
-        auto& fst_result = get_stmt(kb_sample, 6).getUsedVariables();
+        auto fst_result = var_names(kb_sample, get_stmt(kb_sample, 6).getUsedVariableIds());
         CHECK(fst_result.size() == 2);
         CHECK(fst_result.count("x"));
         CHECK(fst_result.count("z"));
 
-        auto& snd_result = get_stmt(kb_sample, 14).getUsedVariables();
+        auto snd_result = var_names(kb_sample, get_stmt(kb_sample, 14).getUsedVariableIds());
         CHECK(snd_result.size() == 4);
         CHECK(snd_result.count("i"));
         CHECK(snd_result.count("x"));
@@ -257,14 +278,14 @@ TEST_CASE("Uses(DeclaredStmt, AllVar)")
 
     SECTION("Uses(DeclaredStmt, AllVar) for procCalls")
     {
-        auto& fst_result = get_stmt(kb_trivial, 3).getUsedVariables();
+        auto fst_result = var_names(kb_trivial, get_stmt(kb_trivial, 3).getUsedVariableIds());
         CHECK(fst_result.size() == 4);
         CHECK(fst_result.count("cenX"));
         CHECK(fst_result.count("cenY"));
         CHECK(fst_result.count("flag"));
         CHECK(fst_result.count("normSq"));
 
-        auto& snd_result = get_stmt(kb_sample, 10).getUsedVariables();
+        auto snd_result = var_names(kb_sample, get_stmt(kb_sample, 10).getUsedVariableIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("x"));
         CHECK(snd_result.count("z"));
@@ -275,7 +296,7 @@ TEST_CASE("Uses(DeclaredProc, AllVar)")
 {
     SECTION("Uses(DeclaredProc, AllVar) for assignment and print")
     {
-        auto& fst_result = get_proc(kb_trivial, "main").getUsedVariables();
+        auto fst_result = var_names(kb_trivial, get_proc(kb_trivial, "main").getUsedVariableIds());
         CHECK(fst_result.size() == 7);
         CHECK(fst_result.count("cenX"));
         CHECK(fst_result.count("cenY"));
@@ -285,10 +306,10 @@ TEST_CASE("Uses(DeclaredProc, AllVar)")
         CHECK(fst_result.count("x"));
         CHECK(fst_result.count("y"));
 
-        auto& snd_result = get_proc(kb_trivial, "readPoint").getUsedVariables();
+        auto snd_result = var_names(kb_trivial, get_proc(kb_trivial, "readPoint").getUsedVariableIds());
         CHECK(snd_result.size() == 0);
 
-        auto& trd_result = get_proc(kb_trivial, "computeCentroid").getUsedVariables();
+        auto trd_result = var_names(kb_trivial, get_proc(kb_trivial, "computeCentroid").getUsedVariableIds());
         CHECK(trd_result.size() == 5);
         CHECK(trd_result.count("cenX"));
         CHECK(trd_result.count("cenY"));
@@ -296,7 +317,7 @@ TEST_CASE("Uses(DeclaredProc, AllVar)")
         CHECK(trd_result.count("x"));
         CHECK(trd_result.count("y"));
 
-        auto& frh_result = get_proc(kb_trivial, "printResults").getUsedVariables();
+        auto frh_result = var_names(kb_trivial, get_proc(kb_trivial, "printResults").getUsedVariableIds());
         CHECK(frh_result.size() == 4);
         CHECK(frh_result.count("cenX"));
         CHECK(frh_result.count("cenY"));
@@ -400,12 +421,12 @@ TEST_CASE("Uses(Synonym, DeclaredVar)")
 
     SECTION("Uses(PROCEDURE, DeclaredVar)")
     {
-        auto fst_result = get_var(kb_sample, "y").getUsingProcNames();
+        auto fst_result = proc_names(kb_sample, get_var(kb_sample, "y").getUsingProcIds());
         CHECK(fst_result.size() == 2);
         CHECK(fst_result.count("Example"));
         CHECK(fst_result.count("p"));
 
-        auto snd_result = get_var(kb_trivial, "flag").getUsingProcNames();
+        auto snd_result = proc_names(kb_trivial, get_var(kb_trivial, "flag").getUsingProcIds());
         CHECK(snd_result.size() == 2);
         CHECK(snd_result.count("printResults"));
         CHECK(snd_result.count("main"));
@@ -417,43 +438,43 @@ TEST_CASE("Uses(Synonym, DeclaredVar)")
 // this is used for the pattern evaluation, but is contingent on the PKB extracting it correctly.
 TEST_CASE("if statement condition uses")
 {
-    auto c1 = get_stmt(kb_sample, 6).getVariablesUsedInCondition();
+    auto c1 = var_names(kb_sample, get_stmt(kb_sample, 6).getVariableIdsUsedInCondition());
     CHECK(c1.size() == 1);
     CHECK(c1.count("x") == 1);
     CHECK(c1.count("z") == 0);
     CHECK(c1.count("y") == 0);
 
-    auto c2 = get_stmt(kb_sample, 13).getVariablesUsedInCondition();
+    auto c2 = var_names(kb_sample, get_stmt(kb_sample, 13).getVariableIdsUsedInCondition());
     CHECK(c2.size() == 1);
     CHECK(c2.count("x") == 1);
     CHECK(c2.count("z") == 0);
     CHECK(c2.count("y") == 0);
 
-    auto c3 = get_stmt(kb_sample, 22).getVariablesUsedInCondition();
+    auto c3 = var_names(kb_sample, get_stmt(kb_sample, 22).getVariableIdsUsedInCondition());
     CHECK(c3.size() == 1);
     CHECK(c3.count("x") == 1);
     CHECK(c3.count("z") == 0);
     CHECK(c3.count("y") == 0);
 
-    CHECK(get_stmt(kb_sample, 10).getVariablesUsedInCondition().empty());
+    CHECK(get_stmt(kb_sample, 10).getVariableIdsUsedInCondition().empty());
 }
 
 
 TEST_CASE("while loop condition uses")
 {
-    auto c1 = get_stmt(kb_sample, 4).getVariablesUsedInCondition();
+    auto c1 = var_names(kb_sample, get_stmt(kb_sample, 4).getVariableIdsUsedInCondition());
     CHECK(c1.size() == 1);
     CHECK(c1.count("i") == 1);
     CHECK(c1.count("z") == 0);
     CHECK(c1.count("y") == 0);
 
-    auto c2 = get_stmt(kb_sample, 14).getVariablesUsedInCondition();
+    auto c2 = var_names(kb_sample, get_stmt(kb_sample, 14).getVariableIdsUsedInCondition());
     CHECK(c2.size() == 1);
     CHECK(c2.count("i") == 1);
     CHECK(c2.count("z") == 0);
     CHECK(c2.count("y") == 0);
 
-    auto c3 = get_stmt(kb_trivial, 14).getVariablesUsedInCondition();
+    auto c3 = var_names(kb_trivial, get_stmt(kb_trivial, 14).getVariableIdsUsedInCondition());
     CHECK(c3.size() == 2);
     CHECK(c3.count("x") == 1);
     CHECK(c3.count("y") == 1);
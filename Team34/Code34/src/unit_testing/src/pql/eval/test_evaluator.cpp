@@ -41,6 +41,14 @@ TEST_CASE("boolean edge cases")
     TEST_OK(prog_1, "stmt a, b; Select BOOLEAN such that Follows(a, b) with a.stmt# = b.stmt#", "FALSE");
     TEST_OK(prog_1, "stmt a, b; Select BOOLEAN with a.stmt# = b.stmt# such that Follows(a, b)", "FALSE");
 
+    // these need the search to back out of the first values it tries
+    TEST_OK(prog_1, "stmt a, b, c; Select BOOLEAN such that Follows(a, b) and Follows(b, c) and Follows(c, a)",
+        "FALSE");
+    TEST_OK(prog_1, "stmt a, b, c; Select BOOLEAN such that Follows*(a, b) and Follows(b, c) and Follows*(a, c)",
+        "TRUE");
+    TEST_OK(prog_1, "stmt a, b, c; Select BOOLEAN such that Follows*(a, b) and Follows*(b, c) and Follows(a, c)",
+        "FALSE");
+
     TEST_OK(prog_2,
         "assign a0,a1,a2,a3,a4,a5,a6,a7,a8,a9,aA,aB,aC,aD,aE,aF; Select BOOLEAN such that "
         "Follows(a0,a1) and Follows(a1,a2) and Follows(a2,a3) and Follows(a3,a4) and Follows(a4,a5) and "
@@ -110,4 +118,144 @@ TEST_CASE("prog_line")
 TEST_CASE("bad arguments")
 {
     TEST_EMPTY(prog_1, "procedure a, b; Select <a, b> such that Follows(a, b)");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Clause scheduling")
+{
+    auto query = pql::parser::parsePQL("assign a1, a2; variable v; Select a1 such that Affects*(a1, a2) "
+                                       "and Uses(a2, v) pattern a1(v, _) with a1.stmt# = 5 such that Follows(1, 2)");
+    auto order = pql::eval::scheduleClauses(query->select.clauses);
+    REQUIRE(order.size() == 5);
+
+    // constants, then the with literal, then the pattern, and the transitive affects last
+    CHECK(dynamic_cast<const pql::ast::Follows*>(order[0]));
+    CHECK(dynamic_cast<const pql::ast::WithCond*>(order[1]));
+    CHECK(dynamic_cast<const pql::ast::AssignPatternCond*>(order[2]));
+    CHECK(dynamic_cast<const pql::ast::UsesS*>(order[3]));
+    CHECK(dynamic_cast<const pql::ast::AffectsT*>(order[4]));
+
+    // and the result should not depend on the order the clauses were written in
+    TEST_OK(prog_1, "assign a, b; Select a such that Follows*(a, b) with b.stmt# = 2", 1);
+    TEST_OK(prog_1, "assign a, b; Select a with b.stmt# = 2 such that Follows*(a, b)", 1);
+}
+
+TEST_CASE("Clause scheduling by number of synonyms")
+{
+    auto query = pql::parser::parsePQL("assign a, a1, a2; stmt s, s1, s2; Select a such that Follows(s1, s2) "
+                                       "and Follows*(s, s1) and Affects*(a, 12) and Follows*(s, 5) "
+                                       "and Affects*(a1, a2)");
+    auto order = pql::eval::scheduleClauses(query->select.clauses);
+    REQUIRE(order.size() == 5);
+
+    // clauses with one synonym go before those joining two, even if they are of a more expensive kind
+    CHECK(order[0] == query->select.clauses[3].get());
+    CHECK(order[1] == query->select.clauses[2].get());
+    CHECK(order[2] == query->select.clauses[0].get());
+    CHECK(order[3] == query->select.clauses[1].get());
+    CHECK(order[4] == query->select.clauses[4].get());
+}
+
+TEST_CASE("Synonym-free clauses")
+{
+    TEST_OK(prog_1, "stmt s; Select BOOLEAN such that Follows(2, 1)", "FALSE");
+    TEST_OK(prog_1, "stmt s; Select BOOLEAN such that Follows(1, 2) and Next*(_, _)", "TRUE");
+    TEST_OK(prog_1, "stmt s; Select s such that Follows(1, 2) with 3 = 3", 1, 2, 3);
+    TEST_EMPTY(prog_1, "stmt s; Select s such that Follows(s, _) and Parent(_, _)");
+    TEST_EMPTY(prog_1, "stmt s; Select s with 1 = 2");
+
+    // falsity is returned, not thrown
+    auto pkb = pkb::DesignExtractor(simple::parser::parseProgram(prog_1)).run();
+    auto query = pql::parser::parsePQL("Select BOOLEAN such that Follows(2, 1) and Follows(1, 2)");
+    pql::eval::table::Table tbl {};
+    CHECK_FALSE(query->select.clauses[0]->evaluate(pkb.get(), &tbl));
+    CHECK(query->select.clauses[1]->evaluate(pkb.get(), &tbl));
+}
+
+TEST_CASE("Lazy domains")
+{
+    auto decl = pql::ast::Declaration { "s", pql::ast::DESIGN_ENT::STMT };
+    pql::eval::table::Table tbl {};
+
+    size_t built = 0;
+    tbl.setDomainInitialiser(
+        [&built](const pql::ast::Declaration* d) -> pql::eval::table::Domain {
+            built++;
+            return { pql::eval::table::Entry(d, 1), pql::eval::table::Entry(d, 2), pql::eval::table::Entry(d, 3) };
+        },
+        [](const pql::eval::table::Entry& e) -> bool { return e.getStmtNum() >= 1 && e.getStmtNum() <= 3; });
+
+    tbl.declareDomain(&decl);
+    CHECK_FALSE(tbl.hasBuiltDomain(&decl));
+    CHECK(tbl.domainContains(&decl, pql::eval::table::Entry(&decl, 2)));
+    CHECK_FALSE(tbl.domainContains(&decl, pql::eval::table::Entry(&decl, 4)));
+
+    // narrowing a lazy domain only keeps the candidates that would have been in it
+    tbl.narrowDomain(&decl, { pql::eval::table::Entry(&decl, 2), pql::eval::table::Entry(&decl, 4) });
+    CHECK(built == 0);
+    CHECK(tbl.getDomain(&decl) == pql::eval::table::Domain { pql::eval::table::Entry(&decl, 2) });
+
+    auto other = pql::ast::Declaration { "t", pql::ast::DESIGN_ENT::STMT };
+    tbl.declareDomain(&other);
+    CHECK(tbl.getDomain(&other).size() == 3);
+    CHECK(tbl.getDomain(&other).size() == 3);
+    CHECK(built == 1);
+
+    // once built, the domain is filtered and narrowed in place
+    const auto* before = &tbl.getDomain(&other);
+    tbl.filterDomain(&other, [](const pql::eval::table::Entry& e) -> bool { return e.getStmtNum() != 1; });
+    tbl.narrowDomain(&other, { pql::eval::table::Entry(&other, 1), pql::eval::table::Entry(&other, 3) });
+    CHECK(&tbl.getDomain(&other) == before);
+    CHECK(tbl.getDomain(&other) == pql::eval::table::Domain { pql::eval::table::Entry(&other, 3) });
+    CHECK(built == 1);
+}
+
+TEST_CASE("With literals narrow domains without building them")
+{
+    using pql::eval::table::Domain;
+    using pql::eval::table::Entry;
+
+    auto pkb = pkb::DesignExtractor(simple::parser::parseProgram(prog_1)).run();
+    auto query = pql::parser::parsePQL("stmt s, t; constant c; variable v, w; procedure p; Select s with s.stmt# = 2 "
+                                       "and c.value = 3 and v.varName = \"b\" and p.procName = \"A\" "
+                                       "and w.varName = \"z\" and t.stmt# = 4294967298");
+
+    size_t built = 0;
+    pql::eval::table::Table tbl {};
+    tbl.setDomainInitialiser(
+        [&built](const pql::ast::Declaration* d) -> Domain {
+            built++;
+            return {};
+        },
+        [](const Entry& e) -> bool { return true; });
+
+    for(const auto& [_, decl] : query->declarations.getAllDeclarations())
+        tbl.declareDomain(decl);
+
+    for(const auto& clause : query->select.clauses)
+        clause->evaluate(pkb.get(), &tbl);
+
+    auto decl = [&query](const char* name) { return query->declarations.getDeclaration(name); };
+    CHECK(tbl.getDomain(decl("s")) == Domain { Entry(decl("s"), 2) });
+    CHECK(tbl.getDomain(decl("c")) == Domain { Entry(decl("c"), *pkb->maybeGetConstantId("3")) });
+    CHECK(tbl.getDomain(decl("v")) == Domain { Entry(decl("v"), pkb->getVariableNamed("b").getId()) });
+    CHECK(tbl.getDomain(decl("p")) == Domain { Entry(decl("p"), pkb->getProcedureNamed("A").getId()) });
+
+    // names and numbers that are not in the program match nothing
+    CHECK(tbl.getDomain(decl("w")).empty());
+    CHECK(tbl.getDomain(decl("t")).empty());
+    CHECK(built == 0);
+}
+
+TEST_CASE("Streaming results")
+{
+    auto pkb = pkb::DesignExtractor(simple::parser::parseProgram(prog_1)).run();
+    auto eval = pql::eval::Evaluator(pkb.get(), pql::parser::parsePQL("stmt a, b; Select <a, b.stmt#>"));
+
+    // the buffer behind each row is reused, so it has to be copied out during the call
+    std::vector<std::string> rows {};
+    eval.evaluate([&rows](zst::str_view row) { rows.push_back(row.str()); });
+
+    REQUIRE(rows.size() == 9);
+    REQUIRE(std::count(rows.begin(), rows.end(), "1 3") == 1);
+    REQUIRE(std::count(rows.begin(), rows.end(), "3 3") == 1);
+}
@@ -17,6 +17,15 @@ std::vector<std::unique_ptr<pql::ast::Declaration>> generate_decl(int count, int
     return ret;
 }
 
+// the number of result rows, ie. the size of the cross product of the return tables
+size_t count_result_rows(const solver::Solver& solver)
+{
+    size_t ret = 1;
+    for(auto tbl : solver.getRetTbls())
+        ret *= tbl->size();
+    return ret;
+}
+
 util::ArenaVec<solver::IntRow> generate_rows(int count, std::vector<pql::ast::Declaration*> decls)
 {
     util::ArenaVec<solver::IntRow> rows(count);
@@ -166,6 +175,139 @@ TEST_CASE("IntTable")
         REQUIRE(merged_tbl2.getRows().size() == 4);
     }
 
+    SECTION("merge on shared column")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto tbl1 = pql::eval::solver::IntTable(
+            generate_rows(5, { decls[0].get(), decls[1].get() }), { decls[0].get(), decls[1].get() });
+        auto tbl2 = pql::eval::solver::IntTable(
+            generate_rows(10, { decls[1].get(), decls[2].get() }), { decls[1].get(), decls[2].get() });
+
+        // only the rows where a1 agrees should survive, and the shared column should not be duplicated
+        tbl1.merge(tbl2);
+        REQUIRE(tbl1.size() == 5);
+        REQUIRE(tbl1.numColumns() == 3);
+        for(const auto& row : tbl1.getRows())
+        {
+            REQUIRE(row.size() == 3);
+            REQUIRE(row.getVal(decls[0].get()).getStmtNum() == row.getVal(decls[2].get()).getStmtNum());
+        }
+    }
+
+    SECTION("mergeAndFilter")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto tbl1 = pql::eval::solver::IntTable(generate_rows(5, { decls[0].get() }), { decls[0].get() });
+        auto tbl2 = pql::eval::solver::IntTable(generate_rows(5, { decls[1].get() }), { decls[1].get() });
+
+        std::unordered_set<std::pair<pql::eval::table::Entry, pql::eval::table::Entry>> allowed_entries {};
+        for(size_t i = 0; i < 4; i++)
+            allowed_entries.insert({ table::Entry(decls[0].get(), i), table::Entry(decls[1].get(), i + 1) });
+
+        // the join goes from a column of tbl1 to a column of tbl2, so the cross product is never built
+        tbl1.mergeAndFilter(tbl2, pql::eval::table::Join(decls[0].get(), decls[1].get(), allowed_entries));
+        REQUIRE(tbl1.size() == 4);
+        for(const auto& row : tbl1.getRows())
+            REQUIRE(row.getVal(decls[0].get()).getStmtNum() + 1 == row.getVal(decls[1].get()).getStmtNum());
+    }
+
+    SECTION("mergeAndFilter with a lazy join")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto tbl1 = pql::eval::solver::IntTable(generate_rows(5, { a0 }), { a0 });
+        auto tbl2 = pql::eval::solver::IntTable(generate_rows(5, { a1 }), { a1 });
+
+        // a0 < a1, without any stored pairs
+        table::JoinRelation relation {};
+        relation.holds = [](const table::Entry& a, const table::Entry& b) -> bool {
+            return a.getStmtNum() < b.getStmtNum();
+        };
+        relation.forward = [a1](const table::Entry& a) -> std::vector<table::Entry> {
+            std::vector<table::Entry> ret {};
+            for(size_t i = a.getStmtNum() + 1; i < 5; i++)
+                ret.emplace_back(a1, i);
+            return ret;
+        };
+        relation.reverse = [a0](const table::Entry& b) -> std::vector<table::Entry> {
+            std::vector<table::Entry> ret {};
+            for(size_t i = 0; i < b.getStmtNum(); i++)
+                ret.emplace_back(a0, i);
+            return ret;
+        };
+
+        auto join = table::Join(a0, a1, relation, 10);
+        REQUIRE(join.isLazy());
+        REQUIRE(join.isAllowedEntry({ table::Entry(a0, 1), table::Entry(a1, 3) }));
+        REQUIRE_FALSE(join.isAllowedEntry({ table::Entry(a0, 3), table::Entry(a1, 1) }));
+
+        tbl1.mergeAndFilter(tbl2, join);
+        REQUIRE(tbl1.size() == 10);
+        for(const auto& row : tbl1.getRows())
+            REQUIRE(row.getVal(a0).getStmtNum() < row.getVal(a1).getStmtNum());
+
+        join.materialise({ table::Entry(a0, 0), table::Entry(a0, 1) }, { table::Entry(a1, 1), table::Entry(a1, 4) });
+        REQUIRE_FALSE(join.isLazy());
+        REQUIRE(join.getAllowedEntries().size() == 3);
+    }
+
+    SECTION("Joins share their pairs")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        std::unordered_set<std::pair<table::Entry, table::Entry>> allowed_entries {};
+        for(size_t i = 0; i < 4; i++)
+            allowed_entries.insert({ table::Entry(a0, i), table::Entry(a1, i) });
+
+        auto join = table::Join(a0, a1, std::move(allowed_entries));
+        auto copy = join;
+        REQUIRE(&copy.getAllowedEntries() == &join.getAllowedEntries());
+
+        // editing one copy leaves the other alone
+        copy.editAllowedEntries().erase({ table::Entry(a0, 0), table::Entry(a1, 0) });
+        REQUIRE(&copy.getAllowedEntries() != &join.getAllowedEntries());
+        REQUIRE(copy.size() == 3);
+        REQUIRE(join.size() == 4);
+
+        // and once it is not shared, it is edited in place
+        const auto* pairs = &join.getAllowedEntries();
+        join.editAllowedEntries().clear();
+        REQUIRE(&join.getAllowedEntries() == pairs);
+    }
+
+    SECTION("dedupRows")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        // values that differ in more than the lowest byte, with duplicates that are not next to each other
+        std::vector<std::pair<size_t, size_t>> values { { 70000, 1 }, { 3, 300 }, { 70000, 1 }, { 3, 44 },
+            { 3, 300 }, { 70000, 65537 }, { 3, 44 } };
+
+        std::vector<util::ArenaVec<table::Entry>> columns(2);
+        for(auto [v0, v1] : values)
+        {
+            columns[0].push_back(table::Entry(a0, v0));
+            columns[1].push_back(table::Entry(a1, v1));
+        }
+
+        auto tbl = solver::IntTable({ a0, a1 }, std::move(columns));
+        tbl.dedupRows();
+
+        // the first of each duplicate is kept, in the original order
+        std::vector<std::pair<size_t, size_t>> expected { { 70000, 1 }, { 3, 300 }, { 3, 44 }, { 70000, 65537 } };
+        REQUIRE(tbl.size() == expected.size());
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            REQUIRE(tbl.getColumn(a0)[i].getStmtNum() == expected[i].first);
+            REQUIRE(tbl.getColumn(a1)[i].getStmtNum() == expected[i].second);
+        }
+    }
+
     SECTION("mergeColumn")
     {
         std::unique_ptr<pql::ast::Declaration> decl = std::move(generate_decl(1, 0).front());
@@ -240,3 +382,435 @@ TEST_CASE("IntTable")
         REQUIRE(rows.count(row2) == 1);
     }
 }
+
+TEST_CASE("Entry")
+{
+    auto decls = generate_decl(2, 0);
+    auto a = table::Entry(decls[0].get(), 1);
+    auto b = table::Entry(decls[1].get(), 1);
+
+    SECTION("entries with the same value but different declarations are different")
+    {
+        REQUIRE(a != b);
+        REQUIRE(a == table::Entry(decls[0].get(), 1));
+        REQUIRE(a.getDeclaration() == decls[0].get());
+        REQUIRE(b.getDeclaration() == decls[1].get());
+    }
+    SECTION("declarations get new indices after a reset")
+    {
+        table::resetDeclarationIndices();
+        auto b2 = table::Entry(decls[1].get(), 1);
+        auto a2 = table::Entry(decls[0].get(), 1);
+        REQUIRE(a2.getDeclaration() == decls[0].get());
+        REQUIRE(b2.getDeclaration() == decls[1].get());
+        REQUIRE(a2 != b2);
+    }
+    SECTION("each scope has its own mapping")
+    {
+        auto outer = table::Entry(decls[0].get(), 1);
+
+        table::DeclarationIndices indices {};
+        {
+            table::DeclarationIndexScope scope(&indices);
+            auto b2 = table::Entry(decls[1].get(), 1);
+            REQUIRE(b2.getDeclarationIndex() == 1);
+            REQUIRE(b2.getDeclaration() == decls[1].get());
+        }
+
+        // the mapping outside the scope is untouched
+        REQUIRE(outer.getDeclaration() == decls[0].get());
+        REQUIRE(indices.at(1) == decls[1].get());
+    }
+    SECTION("entries stay equal after switching between mappings")
+    {
+        table::DeclarationIndices first {};
+        table::DeclarationIndices second {};
+
+        table::DeclarationIndexScope first_scope(&first);
+        auto b1 = table::Entry(decls[1].get(), 7);
+        auto a1 = table::Entry(decls[0].get(), 7);
+        {
+            table::DeclarationIndexScope second_scope(&second);
+            auto a2 = table::Entry(decls[0].get(), 7);
+            REQUIRE(a2.getDeclarationIndex() == 1);
+        }
+
+        REQUIRE(table::Entry(decls[0].get(), 7) == a1);
+        REQUIRE(table::Entry(decls[1].get(), 7) == b1);
+        REQUIRE(a1.getDeclarationIndex() == 2);
+        REQUIRE(first.at(2) == decls[0].get());
+    }
+}
+
+TEST_CASE("Solver")
+{
+    SECTION("join plan starts small and takes the most selective join first")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> wide {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> narrow {};
+        for(size_t i = 0; i < 10; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            domains[a2].insert(table::Entry(a2, i));
+            wide.insert({ table::Entry(a0, i), table::Entry(a1, i) });
+            wide.insert({ table::Entry(a0, i), table::Entry(a1, (i + 1) % 10) });
+        }
+        narrow.insert({ table::Entry(a1, 0), table::Entry(a2, 0) });
+        narrow.insert({ table::Entry(a1, 1), table::Entry(a2, 1) });
+
+        table::Join wide_join(a0, a1, wide);
+        table::Join narrow_join(a1, a2, narrow);
+
+        solver::Solver solver({ wide_join, narrow_join }, domains, { a0, a1, a2 }, {});
+        REQUIRE(solver.getPlans().size() == 1);
+
+        const auto& plan = solver.getPlans().front();
+        REQUIRE(plan.size() == 3);
+        REQUIRE(plan[0].kind == solver::PlanStep::Kind::kScan);
+        REQUIRE(plan[0].decl != a0);
+        REQUIRE(plan[1].kind == solver::PlanStep::Kind::kMerge);
+        REQUIRE(plan[1].join->getId() == narrow_join.getId());
+        REQUIRE(plan[2].kind == solver::PlanStep::Kind::kMerge);
+        REQUIRE(plan[2].decl == a0);
+
+        REQUIRE(solver.isValid());
+        REQUIRE(count_result_rows(solver) == 4);
+    }
+
+    SECTION("semi-join reduction removes entries without partners before joining")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> first {};
+        for(size_t i = 0; i < 10; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            domains[a2].insert(table::Entry(a2, i));
+            first.insert({ table::Entry(a0, i), table::Entry(a1, i) });
+        }
+
+        // only a1 = 3 has a partner in the second join, so everything else in the first join is dangling
+        std::unordered_set<std::pair<table::Entry, table::Entry>> second {};
+        second.insert({ table::Entry(a1, 3), table::Entry(a2, 7) });
+        second.insert({ table::Entry(a1, 3), table::Entry(a2, 8) });
+
+        solver::Solver solver({ table::Join(a0, a1, first), table::Join(a1, a2, second) }, domains, { a0, a2 }, { a1 });
+        REQUIRE(solver.getPlans().size() == 1);
+
+        const auto& plan = solver.getPlans().front();
+        REQUIRE(plan.size() == 3);
+        REQUIRE(plan[0].estimated_rows == 1);
+        for(const auto& step : plan)
+        {
+            if(step.join != nullptr && step.join->getDeclA() == a0)
+                REQUIRE(step.join->getAllowedEntries().size() == 1);
+            REQUIRE(step.estimated_rows <= 2);
+        }
+
+        REQUIRE(solver.isValid());
+        REQUIRE(count_result_rows(solver) == 2);
+    }
+
+    SECTION("semi-join reduction empties every domain of a component without answers")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        for(size_t i = 0; i < 3; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            domains[a2].insert(table::Entry(a2, i));
+        }
+
+        // a1 = 1 is the only partner in the first join, but it has none in the second
+        std::unordered_set<std::pair<table::Entry, table::Entry>> first {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> second {};
+        first.insert({ table::Entry(a0, 0), table::Entry(a1, 1) });
+        second.insert({ table::Entry(a1, 2), table::Entry(a2, 0) });
+
+        solver::Solver solver({ table::Join(a0, a1, first), table::Join(a1, a2, second) }, domains, { a0 }, { a1, a2 });
+        REQUIRE_FALSE(solver.isValid());
+
+        // the scan of the empty domain is the only step that ran
+        REQUIRE(solver.getPlans().size() == 1);
+        REQUIRE(solver.getPlans().front().size() == 1);
+        REQUIRE(solver.getPlans().front().front().kind == solver::PlanStep::Kind::kScan);
+    }
+
+    SECTION("cyclic components are bound one declaration at a time")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        // a0 < a1 < a2, with the last join closing the triangle
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> less01 {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> less12 {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> less02 {};
+        for(size_t i = 0; i < 6; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            domains[a2].insert(table::Entry(a2, i));
+            for(size_t k = i + 1; k < 6; k++)
+            {
+                less01.insert({ table::Entry(a0, i), table::Entry(a1, k) });
+                less12.insert({ table::Entry(a1, i), table::Entry(a2, k) });
+                less02.insert({ table::Entry(a0, i), table::Entry(a2, k) });
+            }
+        }
+
+        std::vector<table::Join> joins { table::Join(a0, a1, less01), table::Join(a1, a2, less12),
+            table::Join(a0, a2, less02) };
+
+        solver::DepGraph graph({ a0, a1, a2 }, joins);
+        REQUIRE(graph.isCyclic({ a0, a1, a2 }));
+        REQUIRE_FALSE(solver::DepGraph({ a0, a1, a2 }, { joins[0], joins[1] }).isCyclic({ a0, a1, a2 }));
+
+        solver::Solver solver(joins, domains, { a0, a1, a2 }, {});
+        REQUIRE(solver.getPlans().size() == 1);
+
+        const auto& plan = solver.getPlans().front();
+        REQUIRE(plan.size() == 3);
+        for(const auto& step : plan)
+            REQUIRE(step.kind == solver::PlanStep::Kind::kBind);
+
+        // choose 3 of 6
+        REQUIRE(solver.isValid());
+        REQUIRE(solver.getRetTbls().size() == 1);
+        const auto& tbl = *solver.getRetTbls().front();
+        REQUIRE(tbl.size() == 20);
+        for(size_t i = 0; i < tbl.size(); i++)
+        {
+            REQUIRE(tbl.getColumn(a0)[i].getStmtNum() < tbl.getColumn(a1)[i].getStmtNum());
+            REQUIRE(tbl.getColumn(a1)[i].getStmtNum() < tbl.getColumn(a2)[i].getStmtNum());
+        }
+    }
+
+    SECTION("disjoint components are kept apart")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        for(size_t i = 0; i < 3; i++)
+            domains[a0].insert(table::Entry(a0, i));
+        for(size_t i = 0; i < 4; i++)
+            domains[a1].insert(table::Entry(a1, i));
+
+        solver::Solver solver({}, domains, { a0, a1 }, {});
+        REQUIRE(solver.isValid());
+
+        auto tbls = solver.getRetTbls();
+        REQUIRE(tbls.size() == 2);
+        REQUIRE(tbls[0]->size() + tbls[1]->size() == 7);
+        REQUIRE(count_result_rows(solver) == 12);
+    }
+
+    SECTION("lazy joins are walked from the smaller domain")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        // a0 < a1, where a1 is already narrowed down to one value. going forward from every a0 would
+        // visit every pair, so only reverse should be used.
+        size_t forward_calls = 0;
+        table::JoinRelation relation {};
+        relation.holds = [](const table::Entry& a, const table::Entry& b) -> bool {
+            return a.getStmtNum() < b.getStmtNum();
+        };
+        relation.forward = [a1, &forward_calls](const table::Entry& a) -> std::vector<table::Entry> {
+            forward_calls++;
+            std::vector<table::Entry> ret {};
+            for(size_t i = a.getStmtNum() + 1; i < 100; i++)
+                ret.emplace_back(a1, i);
+            return ret;
+        };
+        relation.reverse = [a0](const table::Entry& b) -> std::vector<table::Entry> {
+            std::vector<table::Entry> ret {};
+            for(size_t i = 0; i < b.getStmtNum(); i++)
+                ret.emplace_back(a0, i);
+            return ret;
+        };
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        for(size_t i = 0; i < 100; i++)
+            domains[a0].insert(table::Entry(a0, i));
+        domains[a1] = { table::Entry(a1, 10) };
+
+        // too many pairs to materialise up front, so the join is still lazy when it is reduced
+        solver::Solver solver({ table::Join(a0, a1, relation, solver::MAX_MATERIALISED_PAIRS + 1) }, domains,
+            { a0, a1 }, {});
+        REQUIRE(solver.isValid());
+        REQUIRE(forward_calls == 0);
+
+        REQUIRE(solver.getRetTbls().size() == 1);
+        const auto& tbl = *solver.getRetTbls().front();
+        REQUIRE(tbl.size() == 10);
+        for(size_t i = 0; i < tbl.size(); i++)
+        {
+            REQUIRE(tbl.getColumn(a0)[i].getStmtNum() < 10);
+            REQUIRE(tbl.getColumn(a1)[i].getStmtNum() == 10);
+        }
+    }
+
+    SECTION("declarations that are not returned are dropped once their joins are done")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        // a1 only has 2 values, so it is scanned first, and a0 is brought in through it. after that, a1 is not
+        // needed any more: dropping it leaves every a0 once instead of twice, before a2 is joined with it.
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> first {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> second {};
+        domains[a1] = { table::Entry(a1, 0), table::Entry(a1, 1) };
+        for(size_t i = 0; i < 5; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a2].insert(table::Entry(a2, i));
+            first.insert({ table::Entry(a0, i), table::Entry(a1, 0) });
+            first.insert({ table::Entry(a0, i), table::Entry(a1, 1) });
+            for(size_t k = 0; k < 5; k++)
+                second.insert({ table::Entry(a0, i), table::Entry(a2, k) });
+        }
+
+        solver::Solver solver({ table::Join(a0, a1, first), table::Join(a0, a2, second) }, domains, { a0, a2 }, { a1 });
+        REQUIRE(solver.isValid());
+
+        const auto& plan = solver.getPlans().front();
+        REQUIRE(plan.size() == 3);
+        REQUIRE(plan[0].decl == a1);
+        REQUIRE(plan[1].decl == a0);
+        REQUIRE(plan[1].estimated_rows == 10);
+        REQUIRE(plan[1].actual_rows == 5);
+        REQUIRE(plan[2].decl == a2);
+        REQUIRE(plan[2].actual_rows == 25);
+
+        REQUIRE(solver.getRetTbls().size() == 1);
+        const auto& tbl = *solver.getRetTbls().front();
+        REQUIRE(tbl.numColumns() == 2);
+        REQUIRE(tbl.size() == 25);
+    }
+
+    SECTION("declarations that are projected away have no table")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> pairs {};
+        for(size_t i = 0; i < 3; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            pairs.insert({ table::Entry(a0, i), table::Entry(a1, i) });
+        }
+
+        solver::Solver solver({ table::Join(a0, a1, pairs) }, domains, { a0 }, { a1 });
+        REQUIRE(solver.isValid());
+        REQUIRE(solver.hasTable(a0));
+        REQUIRE_FALSE(solver.hasTable(a1));
+        REQUIRE_THROWS(solver.getTableIndex(a1));
+    }
+
+    SECTION("declarations in the same component share a table")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(3, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+        auto a2 = decls[2].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> pairs {};
+        for(size_t i = 0; i < 3; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            domains[a2].insert(table::Entry(a2, i));
+            pairs.insert({ table::Entry(a0, i), table::Entry(a1, (i + 1) % 3) });
+        }
+
+        solver::Solver solver({ table::Join(a0, a1, pairs) }, domains, { a0, a1, a2 }, {});
+        REQUIRE(solver.isValid());
+        REQUIRE(solver.getTableIndex(a0) == solver.getTableIndex(a1));
+        REQUIRE(solver.getTableIndex(a0) != solver.getTableIndex(a2));
+
+        // every table holds a returned declaration, so the returned tables are all of them, in order
+        auto tbls = solver.getRetTbls();
+        REQUIRE(tbls.size() == 2);
+        REQUIRE(tbls[solver.getTableIndex(a0)]->getHeaders() == solver::TableHeaders { a0, a1 });
+        REQUIRE(tbls[solver.getTableIndex(a2)]->getHeaders() == solver::TableHeaders { a2 });
+    }
+
+    SECTION("joins of a declaration with itself are only counted once")
+    {
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(2, 0);
+        auto a0 = decls[0].get();
+        auto a1 = decls[1].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> self {};
+        std::unordered_set<std::pair<table::Entry, table::Entry>> pairs {};
+        for(size_t i = 0; i < 3; i++)
+        {
+            domains[a0].insert(table::Entry(a0, i));
+            domains[a1].insert(table::Entry(a1, i));
+            self.insert({ table::Entry(a0, i), table::Entry(a0, i) });
+            pairs.insert({ table::Entry(a0, i), table::Entry(a1, i) });
+        }
+
+        solver::Solver solver({ table::Join(a0, a0, self), table::Join(a0, a1, pairs) }, domains, { a0, a1 }, {});
+        REQUIRE(solver.isValid());
+        REQUIRE(solver.getComponentJoins({ a0, a1 }) == std::vector<size_t> { 0, 1 });
+        REQUIRE(solver.getComponentJoins({ a0 }) == std::vector<size_t> { 0, 1 });
+        REQUIRE(solver.getComponentJoins({ a1 }).empty());
+    }
+
+    SECTION("declarations the solver was not given have no table")
+    {
+        // a mapping of our own, so that earlier tests' declarations (which may share addresses) are not in it
+        table::DeclarationIndices indices {};
+        table::DeclarationIndexScope scope(&indices);
+
+        std::vector<std::unique_ptr<pql::ast::Declaration>> decls = generate_decl(1, 0);
+        auto a0 = decls[0].get();
+
+        std::unordered_map<const pql::ast::Declaration*, table::Domain> domains {};
+        domains[a0] = { table::Entry(a0, 0) };
+
+        solver::Solver solver({}, domains, { a0 }, {});
+        REQUIRE(solver.hasTable(a0));
+
+        // this one is given an index after the solver was built, so it is past the end of its lookups
+        auto other = generate_decl(1, 1);
+        auto a1 = other[0].get();
+        REQUIRE(table::getDeclarationIndex(a1) > table::getDeclarationIndex(a0));
+        REQUIRE_FALSE(solver.hasTable(a1));
+        REQUIRE_THROWS(solver.getTableIndex(a1));
+        REQUIRE(solver.getComponentJoins({ a1 }).empty());
+    }
+}
@@ -128,6 +128,21 @@ TEST_CASE("with stmt#/value")
     TEST_EMPTY(prog_1, "prog_line x; constant a; Select a with x.stmt# = a.value");
 }
 
+TEST_CASE("with value/stmt#")
+{
+    TEST_OK(prog_1, "stmt a; constant c; Select a with c.value = a.stmt#", 2, 5, 1);
+
+    // constants that are not statement numbers, including ones too big for a statement number
+    constexpr auto prog = R"(
+        procedure a {
+            x = 4294967297;
+            y = 1;
+            z = 18446744073709551617; }
+    )";
+    TEST_OK(prog, "stmt s; constant c; Select s with c.value = s.stmt#", 1);
+    TEST_OK(prog, "stmt s; constant c; Select s with s.stmt# = c.value", 1);
+}
+
 TEST_CASE("with stmt#/number")
 {
     TEST_EMPTY(prog_1, "prog_line a; Select a with a.stmt# = 69");
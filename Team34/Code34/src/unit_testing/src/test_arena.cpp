@@ -0,0 +1,60 @@
+#define CATCH_CONFIG_FAST_COMPILE 1
+#include "catch.hpp"
+
+#include <cstdint>
+#include "arena.h"
+
+TEST_CASE("Arena")
+{
+    SECTION("Allocations are aligned and counted")
+    {
+        util::Arena arena {};
+        auto a = arena.allocate(3, 1);
+        auto b = arena.allocate(16, 16);
+        REQUIRE(((uintptr_t) b % 16) == 0);
+        REQUIRE(a != b);
+        REQUIRE(arena.stats().bytes_used >= 19);
+        REQUIRE(arena.stats().num_chunks == 1);
+    }
+
+    SECTION("Chunks are recycled on reset")
+    {
+        util::Arena arena {};
+        auto first = arena.allocate(64, 8);
+        arena.reset();
+        REQUIRE(arena.stats().bytes_used == 0);
+        REQUIRE(arena.stats().peak_bytes_used >= 64);
+
+        // the same chunk comes back, without asking malloc again
+        REQUIRE(arena.allocate(64, 8) == first);
+        REQUIRE(arena.stats().chunks_allocated == 1);
+        REQUIRE(arena.stats().chunks_recycled == 1);
+    }
+
+    SECTION("Large allocations get their own chunk")
+    {
+        util::Arena arena {};
+        auto small = (uint8_t*) arena.allocate(8, 8);
+        arena.allocate(1024 * 1024, 8);
+        REQUIRE(arena.stats().num_chunks == 2);
+
+        // and the first chunk keeps being used for the small ones
+        REQUIRE((uint8_t*) arena.allocate(8, 8) == small + 8);
+    }
+
+    SECTION("Scopes reset the current arena")
+    {
+        {
+            util::ArenaScope scope {};
+            util::ArenaVec<int> ints(1000);
+            {
+                // nested scopes leave it alone
+                util::ArenaScope inner {};
+            }
+            REQUIRE(util::Arena::current().stats().bytes_used >= 1000 * sizeof(int));
+        }
+
+        REQUIRE(util::Arena::current().stats().bytes_used == 0);
+        REQUIRE(util::Arena::current().stats().peak_bytes_used >= 1000 * sizeof(int));
+    }
+}
@@ -88,3 +88,48 @@ TEST_CASE("Populate PKB")
         REQUIRE_THROWS_WITH(DesignExtractor(std::move(prog)).run(), "no procedure named 'C'");
     }
 }
+
+TEST_CASE("Ids for variables, procedures and constants")
+{
+    constexpr const auto in = R"(
+        procedure main {
+            y = x + 7;
+            call foo;
+        }
+        procedure foo {
+            read y;
+            print a;
+            z = 7 + 3;
+        }
+    )";
+
+    auto kb = DesignExtractor(parseProgram(in)).run();
+
+    REQUIRE(kb->getNumProcedures() == 2);
+    REQUIRE(kb->getNumVariables() == 4);
+    REQUIRE(kb->getNumConstants() == 2);
+
+    // procedures go in source order, variables and constants by name.
+    CHECK(kb->getProcedureWithId(0).getName() == "main");
+    CHECK(kb->getProcedureWithId(1).getName() == "foo");
+    CHECK(kb->getVariableWithId(0).getName() == "a");
+    CHECK(kb->getVariableWithId(3).getName() == "z");
+    CHECK(kb->getConstantWithId(0) == "3");
+    CHECK(kb->maybeGetConstantId("7") == 1);
+    CHECK_FALSE(kb->maybeGetConstantId("2").has_value());
+
+    for(VarId i = 0; i < kb->getNumVariables(); i++)
+        CHECK(kb->getVariableNamed(kb->getVariableWithId(i).getName()).getId() == i);
+
+    auto y = kb->getVariableNamed("y").getId();
+    auto& main = kb->getProcedureNamed("main");
+    auto& foo = kb->getProcedureNamed("foo");
+
+    CHECK(main.modifiesVariable(y));
+    CHECK(main.callsProcedure(foo.getId()));
+    CHECK(foo.isCalledByProcedure(main.getId()));
+    CHECK(kb->getVariableNamed("y").getModifyingProcIds() == ProcIdSet { main.getId(), foo.getId() });
+    CHECK(kb->getStatementAt(1).getUsedVariableIds() == VarIdSet { kb->getVariableNamed("x").getId() });
+
+    CHECK_THROWS_WITH(kb->getVariableWithId(4), "no variable with id 4");
+}